@@ -0,0 +1,123 @@
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include "network-monitor/event_log.h"
+#include "network-monitor/file_downloader.h"
+#include "network-monitor/passenger_event_generator.h"
+#include "network-monitor/station_index.h"
+
+// Write synthetic passenger events to an event log, then scan it back:
+// once in full, counting the passengers in and out of every station, and
+// once over a one-hour window, which skips the blocks outside it.
+//
+// Usage: network-monitor-bench-event-log
+//          [n_events=100000000] [directory=<temp>/network-monitor-bench-log]
+//
+// The directory is wiped before and after the run. Scans run on a warm page
+// cache, right after the writes.
+
+//===========================================================================
+// Seconds elapsed since start
+//===========================================================================
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now()-start).count();
+} // End of seconds_since
+
+int main(int argc, char* argv[])
+{
+  const std::size_t n_events{argc>1 ? std::stoul(argv[1]) : 100000000};
+  const std::filesystem::path directory{
+    argc>2 ? std::filesystem::path{argv[2]} :
+    std::filesystem::temp_directory_path()/"network-monitor-bench-log"};
+
+  const nlohmann::json layout=NetworkMonitor::parse_json_file(
+    BENCHMARKS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  NetworkMonitor::PassengerEventGeneratorOptions options{};
+  options.trips_per_second=1000.0;
+  NetworkMonitor::PassengerEventGenerator generator{layout,stations,options};
+  std::filesystem::remove_all(directory);
+
+  // Write
+  auto start{std::chrono::steady_clock::now()};
+  {
+    NetworkMonitor::EventLogWriter writer{directory};
+    NetworkMonitor::PassengerEvent event{};
+    for (std::size_t i=0; i<n_events; i++)
+    {
+      generator.next(event);
+      if (!writer.append(event))
+      {
+        std::cerr << "Could not write to " << directory << std::endl;
+        return 1;
+      }
+    }
+  }
+  double seconds{seconds_since(start)};
+  std::uintmax_t n_bytes{0};
+  for (const auto& entry : std::filesystem::directory_iterator{directory})
+  {
+    n_bytes+=entry.file_size();
+  }
+  std::cout << "Generated and wrote " << n_events << " events in " << seconds
+            << " s: " << n_events/seconds/1.0e6 << " M events/s, "
+            << static_cast<double>(n_bytes)/n_events << " bytes per event"
+            << std::endl;
+
+  // Open
+  start=std::chrono::steady_clock::now();
+  const NetworkMonitor::EventLogReader reader{directory};
+  seconds=seconds_since(start);
+  std::cout << "Mapped " << reader.segment_count() << " segments, "
+            << reader.block_count() << " blocks in " << seconds*1.0e3
+            << " ms" << std::endl;
+
+  // Full scan
+  std::vector<std::uint64_t> counts(2*stations.size(),0);
+  start=std::chrono::steady_clock::now();
+  std::size_t n_scanned{reader.scan(
+    reader.min_time(),reader.max_time()+1,
+    [&counts](const NetworkMonitor::EventLogBatch& batch)
+  {
+    for (std::size_t i=0; i<batch.size; i++)
+    {
+      counts[2*batch.stations[i]+static_cast<std::size_t>(
+        batch.directions[i])]++;
+    }
+  })};
+  seconds=seconds_since(start);
+  std::cout << "Scanned " << n_scanned << " events in " << seconds << " s: "
+            << n_scanned/seconds/1.0e6 << " M events/s, "
+            << static_cast<double>(n_bytes)/seconds/1.0e9 << " GB/s"
+            << std::endl;
+
+  // One-hour window in the middle of the log
+  const std::int64_t hour{3600000000};
+  const std::int64_t from{reader.min_time()+
+                          (reader.max_time()-reader.min_time())/2};
+  std::size_t n_batches{0};
+  start=std::chrono::steady_clock::now();
+  n_scanned=reader.scan(from,from+hour,
+                        [&n_batches](const NetworkMonitor::EventLogBatch&)
+  {
+    n_batches++;
+  });
+  seconds=seconds_since(start);
+  std::cout << "Scanned one hour, " << n_scanned << " events, in "
+            << seconds*1.0e3 << " ms: read " << n_batches << " of "
+            << reader.block_count() << " blocks" << std::endl;
+
+  std::filesystem::remove_all(directory);
+  return (n_scanned>0) ? 0 : 1;
+}
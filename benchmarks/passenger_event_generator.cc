@@ -0,0 +1,346 @@
+// Boost-specific libraries
+#include <boost/asio.hpp>
+
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Headers we've defined
+#include "network-monitor/file_downloader.h"
+#include "network-monitor/passenger_event_generator.h"
+#include "network-monitor/passenger_event_parser.h"
+#include "network-monitor/passenger_feed_server.h"
+#include "network-monitor/rtt_histogram.h"
+#include "network-monitor/station_index.h"
+#include "network-monitor/tls_context.h"
+#include "network-monitor/websocket_client.h"
+
+// Synthetic passenger events as a load source: raw generator throughput,
+// then the same events published through a local PassengerFeedServer over
+// TLS to loopback subscribers. The subscribers are the WebSocketClient and
+// PassengerEventParser the live feed uses, and measure the feed latency
+// from the sent-at header of every frame.
+//
+// Usage: network-monitor-bench-passenger-event-generator
+//          [n_threads=hardware threads] [events_per_thread=1000000]
+//          [frames_per_message=1] [n_subscribers=1]
+//
+// With frames_per_message=1 every event is its own message, as on the live
+// feed. Larger values pack several STOMP frames in one message, which the
+// subscribers split on the NULL octet.
+
+//===========================================================================
+// A STOMP subscriber to /passengers that decodes every frame it receives
+//===========================================================================
+struct Subscriber
+{
+  Subscriber(const std::string& url,
+             const std::string& endpoint,
+             const std::string& port,
+             boost::asio::io_context& ioc,
+             boost::asio::ssl::context& ctx,
+             const NetworkMonitor::StationIndex& stations) :
+    Client(url,endpoint,port,ioc,ctx),
+    Parser(stations)
+  {
+    Connect_frame.push_back('\0');
+    Subscribe_frame.push_back('\0');
+  }
+
+  void connect(std::atomic<std::size_t>& n_subscribed)
+  {
+    auto on_connect{[this](auto ec)
+    {
+      if (ec)
+      {
+        std::cerr << "connect: " << ec.message() << std::endl;
+        return;
+      }
+      Client.send(Connect_frame);
+    }};
+    auto on_message{[this,&n_subscribed](auto ec, auto message)
+    {
+      if (ec)
+      {
+        std::cerr << "message: " << ec.message() << std::endl;
+        return;
+      }
+      if (message.rfind("MESSAGE\n",0)==0)
+      {
+        on_frames(message);
+      }
+      else if (message.rfind("CONNECTED\n",0)==0)
+      {
+        Client.send(Subscribe_frame);
+      }
+      else if (message.rfind("RECEIPT\n",0)==0)
+      {
+        n_subscribed++;
+      }
+    }};
+    Client.connect(on_connect,on_message);
+  }
+
+  void on_frames(std::string_view message)
+  {
+    const auto now{std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count()};
+    while (!message.empty())
+    {
+      const std::size_t end{std::min(message.find('\0'),message.size())};
+      const std::string_view frame{message.substr(0,end)};
+      NetworkMonitor::PassengerEvent event{};
+      std::int64_t sent_at{0};
+      if (Parser.parse_stomp_frame(frame,event))
+      {
+        N_events++;
+      }
+      if (NetworkMonitor::parse_passenger_event_frame_sent_at(frame,sent_at))
+      {
+        std::lock_guard<std::mutex> lock{Latency_mutex};
+        Latency.record(std::chrono::microseconds(now-sent_at));
+      }
+      message.remove_prefix(std::min(end+1,message.size()));
+    }
+  }
+
+  NetworkMonitor::WebSocketClient Client;
+  const NetworkMonitor::PassengerEventParser Parser;
+  std::string Connect_frame{"CONNECT\naccept-version:1.2\nhost:localhost\n\n"};
+  std::string Subscribe_frame{
+    "SUBSCRIBE\ndestination:/passengers\nid:0\nreceipt:0\n\n"};
+  std::atomic<std::size_t> N_events{0};
+
+  // The client callbacks run on its strand; the lock is for main().
+  std::mutex Latency_mutex{};
+  NetworkMonitor::RttHistogram Latency{1<<16};
+};
+
+//===========================================================================
+// Run one generator per thread; each passes batches of frames_per_message
+// events to on_batch. Returns the wall-clock time it took.
+//===========================================================================
+template <typename OnBatch>
+static double run_generators(const nlohmann::json& layout,
+                             const NetworkMonitor::StationIndex& stations,
+                             unsigned n_threads,
+                             std::size_t events_per_thread,
+                             std::size_t frames_per_message,
+                             OnBatch on_batch)
+{
+  std::vector<std::thread> threads{};
+  const auto start{std::chrono::steady_clock::now()};
+  for (unsigned t=0; t<n_threads; t++)
+  {
+    threads.emplace_back([&,t]()
+    {
+      // Each thread simulates its share of the whole network.
+      NetworkMonitor::PassengerEventGeneratorOptions options{};
+      options.seed=t+1;
+      options.trips_per_second=200.0/n_threads;
+      options.hotspots.push_back({"station_017",20.0});
+      NetworkMonitor::PassengerEventGenerator generator{
+        layout,stations,options};
+
+      std::vector<NetworkMonitor::PassengerEvent> batch{};
+      batch.reserve(frames_per_message);
+      for (std::size_t i=0; i<events_per_thread; i++)
+      {
+        batch.emplace_back();
+        generator.next(batch.back());
+        if (batch.size()==frames_per_message)
+        {
+          on_batch(batch);
+          batch.clear();
+        }
+      }
+      if (!batch.empty())
+      {
+        on_batch(batch);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now()-start).count();
+} // End of run_generators
+
+int main(int argc, char* argv[])
+{
+  const unsigned n_threads{
+    argc>1 ? static_cast<unsigned>(std::stoul(argv[1])) :
+             std::max(1u,std::thread::hardware_concurrency())};
+  const std::size_t events_per_thread{argc>2 ? std::stoul(argv[2]) : 1000000};
+  const std::size_t frames_per_message{
+    std::max<std::size_t>(argc>3 ? std::stoul(argv[3]) : 1,1)};
+  const std::size_t n_subscribers{argc>4 ? std::stoul(argv[4]) : 1};
+
+  const nlohmann::json layout=NetworkMonitor::parse_json_file(
+    BENCHMARKS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  const std::size_t n_events{n_threads*events_per_thread};
+
+  // Generation and STOMP formatting only
+  std::atomic<std::size_t> n_bytes{0};
+  double seconds{run_generators(
+    layout,stations,n_threads,events_per_thread,frames_per_message,
+    [&n_bytes,&stations](const auto& batch)
+  {
+    std::string frames{};
+    for (const auto& event : batch)
+    {
+      NetworkMonitor::append_passenger_event_frame(event,stations,frames);
+    }
+    n_bytes+=frames.size();
+  })};
+  std::cout << "Generated " << n_events << " events on " << n_threads
+            << " threads: " << n_events/seconds/1.0e6 << " M events/s, "
+            << n_bytes/seconds/1.0e9 << " GB/s of STOMP frames"
+            << std::endl;
+
+  // Through the feed server, over TLS. Its certificate is self-signed: the
+  // subscribers trust it as their CA.
+  auto server_ctx{NetworkMonitor::make_tls_server_context(
+    BENCHMARKS_SERVER_CERT_PEM,BENCHMARKS_SERVER_KEY_PEM)};
+  auto client_ctx{NetworkMonitor::make_tls_client_context(
+    BENCHMARKS_SERVER_CERT_PEM)};
+  if ((server_ctx==nullptr) || (client_ctx==nullptr))
+  {
+    return 1;
+  }
+  boost::asio::io_context ioc{};
+  auto work{boost::asio::make_work_guard(ioc)};
+  NetworkMonitor::PassengerFeedServer server{
+    "127.0.0.1",0,ioc,*server_ctx,stations};
+  if (server.run())
+  {
+    return 1;
+  }
+  std::vector<std::thread> io_threads{};
+  for (unsigned i=0; i<n_threads; i++)
+  {
+    io_threads.emplace_back([&ioc]()
+    {
+      ioc.run();
+    });
+  }
+
+  const std::string url{"127.0.0.1"};
+  const std::string endpoint{"/passengers"};
+  const std::string port{std::to_string(server.port())};
+  std::atomic<std::size_t> n_subscribed{0};
+  std::vector<std::unique_ptr<Subscriber>> subscribers{};
+  for (std::size_t i=0; i<n_subscribers; i++)
+  {
+    subscribers.push_back(std::make_unique<Subscriber>(
+      url,endpoint,port,ioc,*client_ctx,stations));
+    subscribers.back()->connect(n_subscribed);
+  }
+  // A subscriber whose connection failed has printed why; give up.
+  const auto subscribe_deadline{std::chrono::steady_clock::now()+
+                                std::chrono::seconds(60)};
+  while ((n_subscribed<n_subscribers) &&
+         (std::chrono::steady_clock::now()<subscribe_deadline))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (n_subscribed<n_subscribers)
+  {
+    std::cerr << "Only " << n_subscribed << " of " << n_subscribers
+              << " subscribers subscribed" << std::endl;
+    ioc.stop();
+    for (auto& thread : io_threads)
+    {
+      thread.join();
+    }
+    return 1;
+  }
+  auto n_received{[&subscribers]()
+  {
+    std::size_t n{0};
+    for (const auto& subscriber : subscribers)
+    {
+      n+=subscriber->N_events;
+    }
+    return n;
+  }};
+
+  const auto start{std::chrono::steady_clock::now()};
+  run_generators(
+    layout,stations,n_threads,events_per_thread,frames_per_message,
+    [&server](const auto& batch)
+  {
+    if (batch.size()==1)
+    {
+      server.publish(batch.front());
+    }
+    else
+    {
+      server.publish(batch);
+    }
+  });
+
+  // Drops are only final once the server has written or dropped every
+  // queued message; then wait for the subscribers to decode the rest.
+  const auto deadline{std::chrono::steady_clock::now()+
+                      std::chrono::seconds(60)};
+  while ((server.pending_message_count()>0) &&
+         (std::chrono::steady_clock::now()<deadline))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const std::size_t n_dropped_messages{server.dropped_message_count()};
+  const std::size_t n_messages{
+    (events_per_thread+frames_per_message-1)/frames_per_message};
+  const std::size_t n_dropped_events{
+    std::min(n_dropped_messages*frames_per_message,n_events*n_subscribers)};
+  const std::size_t n_expected{n_events*n_subscribers-n_dropped_events};
+  while ((n_received()<n_expected) &&
+         (std::chrono::steady_clock::now()<deadline))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  seconds=std::chrono::duration<double>(
+    std::chrono::steady_clock::now()-start).count();
+
+  std::chrono::microseconds p50{0};
+  std::chrono::microseconds p99{0};
+  for (auto& subscriber : subscribers)
+  {
+    std::lock_guard<std::mutex> lock{subscriber->Latency_mutex};
+    p50=std::max(p50,subscriber->Latency.percentile(0.5));
+    p99=std::max(p99,subscriber->Latency.percentile(0.99));
+  }
+  std::cout << "Delivered " << n_received() << " events to "
+            << n_subscribers << " subscribers in " << seconds << " s: "
+            << n_received()/seconds/1.0e6 << " M events/s, "
+            << frames_per_message << " frames per message ("
+            << n_dropped_messages << " of " << n_messages*n_threads*
+               n_subscribers << " messages dropped)" << std::endl;
+  std::cout << "Latency over the last " << (1<<16)
+            << " events per subscriber: p50 " << p50.count() << " us, p99 "
+            << p99.count() << " us (worst subscriber)" << std::endl;
+
+  // Disconnecting the subscribers ends their read loops.
+  server.stop();
+  work.reset();
+  for (auto& thread : io_threads)
+  {
+    thread.join();
+  }
+  return (n_received()>=n_expected) ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include "network-monitor/file_downloader.h"
+#include "network-monitor/passenger_event_parser.h"
+#include "network-monitor/station_index.h"
+
+// Compare the schema-aware passenger event parser against a full
+// nlohmann::json parse followed by field extraction.
+//
+// Usage: network-monitor-bench-passenger-event-parser [payloads.txt]
+//
+// The optional file holds recorded event bodies, one JSON object per line.
+// Without it, we synthesise events for the stations of the test layout.
+
+//===========================================================================
+// Build synthetic payloads shaped like the /network-events bodies
+//===========================================================================
+static std::vector<std::string> make_payloads(
+  const NetworkMonitor::StationIndex& stations,
+  std::size_t n_payloads)
+{
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<std::uint32_t> station{
+    0,static_cast<std::uint32_t>(stations.size()-1)};
+  std::uniform_int_distribution<int> second{0,59};
+  std::vector<std::string> payloads{};
+  payloads.reserve(n_payloads);
+  char datetime[32];
+  for (std::size_t i=0; i<n_payloads; i++)
+  {
+    std::snprintf(datetime,sizeof(datetime),
+                  "2020-11-01T07:%02d:%02d.%06dZ",
+                  second(rng),second(rng),static_cast<int>(i%1000000));
+    payloads.push_back(
+      std::string("{\n  \"datetime\": \"")+datetime+"\",\n"
+      "  \"passenger_event\": \""+(i%2 ? "out" : "in")+"\",\n"
+      "  \"station_id\": \""+stations.station_id(station(rng))+"\"\n}");
+  }
+  return payloads;
+} // End of make_payloads
+
+//===========================================================================
+// Print the throughput of one run
+//===========================================================================
+static void report(const std::string& name,
+                   std::chrono::steady_clock::duration elapsed,
+                   std::size_t n_bytes,
+                   std::size_t n_events,
+                   std::size_t n_parsed)
+{
+  const double seconds{std::chrono::duration<double>(elapsed).count()};
+  std::cout << name << ": "
+            << n_bytes/seconds/1.0e9 << " GB/s, "
+            << n_events/seconds/1.0e6 << " M events/s ("
+            << n_parsed << "/" << n_events << " parsed)" << std::endl;
+} // End of report
+
+int main(int argc, char* argv[])
+{
+  const NetworkMonitor::StationIndex stations
+  {
+    NetworkMonitor::parse_json_file(BENCHMARKS_NETWORK_LAYOUT_JSON)
+  };
+  if (stations.size()==0)
+  {
+    std::cerr << "Could not load the network layout." << std::endl;
+    return 1;
+  }
+
+  // Load the recorded payloads, or make up our own.
+  std::vector<std::string> payloads{};
+  if (argc>1)
+  {
+    std::ifstream file{argv[1]};
+    std::string line{};
+    while (std::getline(file,line))
+    {
+      payloads.push_back(std::move(line));
+    }
+  }
+  else
+  {
+    payloads=make_payloads(stations,1000000);
+  }
+  std::size_t n_bytes{0};
+  for (const auto& payload : payloads)
+  {
+    n_bytes+=payload.size();
+  }
+
+  // Schema-aware parser
+  const NetworkMonitor::PassengerEventParser parser{stations};
+  std::size_t n_parsed{0};
+  std::int64_t checksum{0};
+  auto start{std::chrono::steady_clock::now()};
+  for (const auto& payload : payloads)
+  {
+    NetworkMonitor::PassengerEvent event{};
+    if (parser.parse(payload,event))
+    {
+      n_parsed++;
+      checksum+=event.timestamp+event.station;
+    }
+  }
+  report("PassengerEventParser",std::chrono::steady_clock::now()-start,
+         n_bytes,payloads.size(),n_parsed);
+
+  // Full DOM parse, then the same fields
+  n_parsed=0;
+  start=std::chrono::steady_clock::now();
+  for (const auto& payload : payloads)
+  {
+    const auto json=nlohmann::json::parse(payload,nullptr,false);
+    if (json.is_discarded())
+    {
+      continue;
+    }
+    NetworkMonitor::PassengerEvent event{};
+    event.station=stations.find(json.value("station_id",""));
+    event.direction=(json.value("passenger_event","")=="out" ?
+                     NetworkMonitor::PassengerDirection::Out :
+                     NetworkMonitor::PassengerDirection::In);
+    if ((event.station!=NetworkMonitor::StationIndex::npos) &&
+        NetworkMonitor::parse_iso8601_timestamp(json.value("datetime",""),
+                                                event.timestamp))
+    {
+      n_parsed++;
+      checksum-=event.timestamp+event.station;
+    }
+  }
+  report("nlohmann::json",std::chrono::steady_clock::now()-start,
+         n_bytes,payloads.size(),n_parsed);
+
+  // Both runs decode the same events, so the checksum cancels out.
+  return checksum==0 ? 0 : 1;
+}
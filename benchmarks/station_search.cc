@@ -0,0 +1,118 @@
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include "network-monitor/file_downloader.h"
+#include "network-monitor/station_search.h"
+
+// Latency of station name queries, as typed by a user: every prefix of
+// every station name for prefix search, and names with one or two typos for
+// fuzzy search.
+//
+// Usage: network-monitor-bench-station-search [network-layout.json]
+
+//===========================================================================
+// Introduce n random substitutions in a name
+//===========================================================================
+static std::string add_typos(std::string name,
+                             std::size_t n_typos,
+                             std::mt19937& rng)
+{
+  std::uniform_int_distribution<std::size_t> position{0,name.size()-1};
+  std::uniform_int_distribution<int> letter{'a','z'};
+  for (std::size_t i=0; i<n_typos; i++)
+  {
+    name[position(rng)]=static_cast<char>(letter(rng));
+  }
+  return name;
+} // End of add_typos
+
+//===========================================================================
+// Run every query through a search function and print the mean latency
+//===========================================================================
+template <typename Search>
+static void report(const std::string& what,
+                   const std::vector<std::string>& queries,
+                   Search search)
+{
+  std::size_t n_results{0};
+  const auto start{std::chrono::steady_clock::now()};
+  for (const auto& query : queries)
+  {
+    n_results+=search(query).size();
+  }
+  const double seconds{std::chrono::duration<double>(
+    std::chrono::steady_clock::now()-start).count()};
+  std::cout << what << ": " << queries.size() << " queries, "
+            << seconds/queries.size()*1.0e6 << " us/query, "
+            << static_cast<double>(n_results)/queries.size()
+            << " results/query" << std::endl;
+} // End of report
+
+int main(int argc, char* argv[])
+{
+  const std::string layout_path{argc>1 ? argv[1] :
+                                BENCHMARKS_NETWORK_LAYOUT_JSON};
+  nlohmann::json layout=NetworkMonitor::parse_json_file(layout_path);
+  if (!layout.contains("stations"))
+  {
+    std::cerr << "Could not load " << layout_path << std::endl;
+    return 1;
+  }
+
+  auto start{std::chrono::steady_clock::now()};
+  NetworkMonitor::StationSearch search{layout};
+  std::cout << "Built the index of " << search.size() << " stations in "
+            << std::chrono::duration<double>(
+                 std::chrono::steady_clock::now()-start).count()*1.0e3
+            << " ms" << std::endl;
+
+  std::mt19937 rng{42};
+  std::vector<std::string> prefixes{};
+  std::vector<std::string> typos{};
+  for (const auto& station : layout.at("stations"))
+  {
+    const std::string name{station.at("name").get<std::string>()};
+    for (std::size_t n=1; n<=name.size(); n++)
+    {
+      prefixes.push_back(name.substr(0,n));
+    }
+
+    // The distinctive part of the name, as a user would type it
+    const std::string short_name{name.substr(0,name.find(" Underground"))};
+    typos.push_back(add_typos(short_name,1,rng));
+    typos.push_back(add_typos(short_name,2,rng));
+  }
+
+  report("Prefix search",prefixes,[&search](const std::string& query)
+  {
+    return search.prefix_search(query);
+  });
+  report("Fuzzy search ",typos,[&search](const std::string& query)
+  {
+    return search.fuzzy_search(query);
+  });
+  report("Search       ",typos,[&search](const std::string& query)
+  {
+    return search.search(query);
+  });
+
+  // Reload with one renamed station
+  auto& stations{layout.at("stations")};
+  stations[0]["name"]="Renamed Underground Station";
+  start=std::chrono::steady_clock::now();
+  const std::size_t changed{search.reload(layout)};
+  std::cout << "Reloaded " << changed << " changed station in "
+            << std::chrono::duration<double>(
+                 std::chrono::steady_clock::now()-start).count()*1.0e3
+            << " ms" << std::endl;
+  return 0;
+}
@@ -0,0 +1,203 @@
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+
+// OpenSSL libraries to use SSL/TLS protocols
+#include <openssl/bio.h>
+#include <openssl/ssl.h>
+
+// Regular libraries
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headers we've defined
+#include "network-monitor/tls_context.h"
+
+// Cost of TLS client contexts, and TLS record throughput over loopback with
+// kernel TLS (kTLS) on and off.
+//
+// Usage: network-monitor-bench-tls-context
+//          [megabytes=512] [record_size=16384] [n_contexts=50]
+//
+// The server writes megabytes of application data to the client through
+// TLS 1.2 with AES-128-GCM, the cipher Linux offloads most widely, using the
+// self-signed test certificate, which the client trusts as its CA. Both ends
+// run OpenSSL directly on the socket, which kTLS requires; it engages only
+// if the kernel tls module is loaded (modprobe tls). The output says
+// whether it did.
+
+//===========================================================================
+// Whether kTLS took over the send or receive path of a session
+//===========================================================================
+static bool ktls_send(SSL* ssl)
+{
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+  return BIO_get_ktls_send(SSL_get_wbio(ssl));
+#else
+  (void)ssl;
+  return false;
+#endif
+} // End of ktls_send
+
+static bool ktls_recv(SSL* ssl)
+{
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+  return BIO_get_ktls_recv(SSL_get_rbio(ssl));
+#else
+  (void)ssl;
+  return false;
+#endif
+} // End of ktls_recv
+
+//===========================================================================
+// Stream n_bytes from a local TLS server to a client; returns the client
+// throughput in bytes per second, or zero on failure.
+//===========================================================================
+static double run_transfer(bool enable_ktls,
+                           std::size_t n_bytes,
+                           std::size_t record_size)
+{
+  using boost::asio::ip::tcp;
+
+  // Both sides from the shared factories
+  auto server_ctx_pt{NetworkMonitor::make_tls_server_context(
+    BENCHMARKS_SERVER_CERT_PEM,BENCHMARKS_SERVER_KEY_PEM)};
+  auto client_ctx{NetworkMonitor::make_tls_client_context(
+    BENCHMARKS_SERVER_CERT_PEM)};
+  if (!server_ctx_pt || !client_ctx)
+  {
+    std::cerr << "Could not load " << BENCHMARKS_SERVER_CERT_PEM << std::endl;
+    return 0;
+  }
+  SSL_CTX* server_ctx{server_ctx_pt->native_handle()};
+  SSL_CTX_set_max_proto_version(server_ctx,TLS1_2_VERSION);
+  SSL_CTX_set_cipher_list(server_ctx,"ECDHE-RSA-AES128-GCM-SHA256");
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+  if (enable_ktls)
+  {
+    SSL_CTX_set_options(server_ctx,SSL_OP_ENABLE_KTLS);
+  }
+#endif
+
+  boost::asio::io_context ioc{};
+  tcp::acceptor acceptor{ioc,{boost::asio::ip::make_address("127.0.0.1"),0}};
+  const tcp::endpoint endpoint{acceptor.local_endpoint()};
+
+  bool server_ktls{false};
+  std::thread server{[&]()
+  {
+    tcp::socket socket{ioc};
+    acceptor.accept(socket);
+    SSL* ssl{SSL_new(server_ctx)};
+    SSL_set_fd(ssl,socket.native_handle());
+    if (SSL_accept(ssl)==1)
+    {
+      server_ktls=ktls_send(ssl);
+      const std::vector<char> record(record_size,'x');
+      std::size_t sent{0};
+      while (sent<n_bytes)
+      {
+        const int n{SSL_write(ssl,record.data(),
+                              static_cast<int>(std::min(record_size,
+                                                        n_bytes-sent)))};
+        if (n<=0)
+        {
+          break;
+        }
+        sent+=static_cast<std::size_t>(n);
+      }
+      SSL_shutdown(ssl);
+    }
+    SSL_free(ssl);
+  }};
+
+  tcp::socket socket{ioc};
+  socket.connect(endpoint);
+  SSL* ssl{SSL_new(client_ctx->native_handle())};
+  SSL_set_fd(ssl,socket.native_handle());
+  SSL_set1_host(ssl,"localhost");
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+  if (enable_ktls)
+  {
+    SSL_set_options(ssl,SSL_OP_ENABLE_KTLS);
+  }
+#endif
+  std::size_t received{0};
+  const auto start{std::chrono::steady_clock::now()};
+  bool client_ktls{false};
+  if (SSL_connect(ssl)==1)
+  {
+    client_ktls=ktls_recv(ssl);
+    std::vector<char> buffer(record_size);
+    while (received<n_bytes)
+    {
+      const int n{SSL_read(ssl,buffer.data(),
+                           static_cast<int>(buffer.size()))};
+      if (n<=0)
+      {
+        break;
+      }
+      received+=static_cast<std::size_t>(n);
+    }
+  }
+  const double seconds{std::chrono::duration<double>(
+    std::chrono::steady_clock::now()-start).count()};
+  SSL_free(ssl);
+  socket.close();
+  server.join();
+
+  std::cout << "kTLS " << (enable_ktls ? "requested" : "off      ")
+            << " (engaged: send " << (server_ktls ? "yes" : "no")
+            << ", receive " << (client_ktls ? "yes" : "no") << "): "
+            << received/seconds/1.0e6 << " MB/s" << std::endl;
+  return (received==n_bytes) ? received/seconds : 0;
+} // End of run_transfer
+
+int main(int argc, char* argv[])
+{
+  const std::size_t megabytes{argc>1 ? std::stoul(argv[1]) : 512};
+  const std::size_t record_size{argc>2 ? std::stoul(argv[2]) : 16384};
+  const std::size_t n_contexts{argc>3 ? std::stoul(argv[3]) : 50};
+
+  // Context setup: parse the CA bundle every time, or share one store.
+  {
+    auto start{std::chrono::steady_clock::now()};
+    for (std::size_t i=0; i<n_contexts; i++)
+    {
+      boost::asio::ssl::context ctx{boost::asio::ssl::context::tlsv12_client};
+      ctx.load_verify_file(BENCHMARKS_CACERT_PEM);
+    }
+    const double per_file_load{std::chrono::duration<double>(
+      std::chrono::steady_clock::now()-start).count()/n_contexts};
+
+    start=std::chrono::steady_clock::now();
+    for (std::size_t i=0; i<n_contexts; i++)
+    {
+      auto ctx{NetworkMonitor::make_tls_client_context(
+        BENCHMARKS_CACERT_PEM)};
+    }
+    const double per_shared{std::chrono::duration<double>(
+      std::chrono::steady_clock::now()-start).count()/n_contexts};
+
+    std::cout << "Client context with load_verify_file: "
+              << per_file_load*1.0e6 << " us, shared CA store: "
+              << per_shared*1.0e6 << " us" << std::endl;
+  }
+
+  // Record throughput
+  std::cout << "OpenSSL kTLS support: "
+            << (NetworkMonitor::ktls_supported() ? "yes" : "no")
+            << std::endl;
+  const std::size_t n_bytes{megabytes*1024*1024};
+  const double plain{run_transfer(false,n_bytes,record_size)};
+  const double ktls{run_transfer(true,n_bytes,record_size)};
+  if ((plain>0) && (ktls>0))
+  {
+    std::cout << "kTLS / user-space throughput: " << ktls/plain << std::endl;
+  }
+  return ((plain>0) && (ktls>0)) ? 0 : 1;
+}
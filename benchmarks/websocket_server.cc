@@ -0,0 +1,197 @@
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+
+// Regular libraries
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headers we've defined
+#include "network-monitor/websocket_server.h"
+
+// Fan-out throughput of WebSocketServer to local loopback subscribers.
+//
+// Usage: network-monitor-bench-websocket-server
+//          [n_subscribers=10000] [n_messages=100] [message_size=256]
+//
+// Each subscriber uses two file descriptors in this process (its socket and
+// the server's), so raise the open file limit (ulimit -n) accordingly.
+
+using tcp_web_socket =
+  boost::beast::websocket::stream<boost::beast::tcp_stream>;
+
+//===========================================================================
+// A subscriber that counts the messages it receives
+//===========================================================================
+struct Subscriber : public std::enable_shared_from_this<Subscriber>
+{
+  explicit Subscriber(boost::asio::io_context& ioc) :
+    Web_socket(boost::asio::make_strand(ioc))
+  {}
+
+  void connect(const boost::asio::ip::tcp::endpoint& endpoint,
+               std::atomic<std::size_t>& n_connected,
+               std::atomic<std::size_t>& n_received)
+  {
+    boost::beast::get_lowest_layer(Web_socket).async_connect(
+      endpoint,
+      [self=shared_from_this(),&n_connected,&n_received](auto ec)
+    {
+      if (ec)
+      {
+        std::cerr << "connect: " << ec.message() << std::endl;
+        return;
+      }
+      self->Web_socket.async_handshake(
+        "127.0.0.1","/",
+        [self,&n_connected,&n_received](auto ec)
+      {
+        if (ec)
+        {
+          std::cerr << "handshake: " << ec.message() << std::endl;
+          return;
+        }
+        n_connected++;
+        self->read(n_received);
+      });
+    });
+  }
+
+  void read(std::atomic<std::size_t>& n_received)
+  {
+    Web_socket.async_read(
+      Buffer,
+      [self=shared_from_this(),&n_received](auto ec, auto n_bytes)
+    {
+      if (ec)
+      {
+        return;
+      }
+      self->Buffer.consume(n_bytes);
+      n_received++;
+      self->read(n_received);
+    });
+  }
+
+  tcp_web_socket Web_socket;
+  boost::beast::flat_buffer Buffer{};
+};
+
+//===========================================================================
+// Wait until a counter reaches a value, or give up after a while
+//===========================================================================
+static bool wait_for(const std::atomic<std::size_t>& counter,
+                     std::size_t value,
+                     std::chrono::seconds timeout)
+{
+  const auto deadline{std::chrono::steady_clock::now()+timeout};
+  while (counter<value)
+  {
+    if (std::chrono::steady_clock::now()>deadline)
+    {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+} // End of wait_for
+
+int main(int argc, char* argv[])
+{
+  const std::size_t n_subscribers{argc>1 ? std::stoul(argv[1]) : 10000};
+  const std::size_t n_messages{argc>2 ? std::stoul(argv[2]) : 100};
+  const std::size_t message_size{argc>3 ? std::stoul(argv[3]) : 256};
+
+  // Use as many file descriptors as we are allowed to.
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE,&limit)==0)
+  {
+    limit.rlim_cur=limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE,&limit);
+  }
+
+  boost::asio::io_context ioc{};
+  auto work{boost::asio::make_work_guard(ioc)};
+  NetworkMonitor::WebSocketServer server
+  {
+    "127.0.0.1",0,ioc,n_messages,
+    NetworkMonitor::WebSocketServer::SlowClientPolicy::DropMessages
+  };
+  if (server.run())
+  {
+    return 1;
+  }
+
+  std::vector<std::thread> threads{};
+  const unsigned n_threads{std::max(1u,std::thread::hardware_concurrency())};
+  for (unsigned i=0; i<n_threads; i++)
+  {
+    threads.emplace_back([&ioc]()
+    {
+      ioc.run();
+    });
+  }
+
+  // Connect every subscriber.
+  const boost::asio::ip::tcp::endpoint endpoint{
+    boost::asio::ip::make_address("127.0.0.1"),server.port()};
+  std::atomic<std::size_t> n_connected{0};
+  std::atomic<std::size_t> n_received{0};
+  std::vector<std::shared_ptr<Subscriber>> subscribers{};
+  for (std::size_t i=0; i<n_subscribers; i++)
+  {
+    subscribers.push_back(std::make_shared<Subscriber>(ioc));
+    subscribers.back()->connect(endpoint,n_connected,n_received);
+  }
+  const bool all_connected{
+    wait_for(n_connected,n_subscribers,std::chrono::seconds(60))};
+  while (server.subscriber_count()<n_connected)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::cout << n_connected << "/" << n_subscribers
+            << " subscribers connected, " << n_threads << " threads"
+            << std::endl;
+
+  // Broadcast and wait for every copy to arrive.
+  const std::size_t n_expected{n_connected*n_messages};
+  const auto start{std::chrono::steady_clock::now()};
+  for (std::size_t i=0; i<n_messages; i++)
+  {
+    server.broadcast(std::string(message_size,'x'));
+  }
+  const bool all_received{
+    wait_for(n_received,n_expected,std::chrono::seconds(120))};
+  const double seconds{std::chrono::duration<double>(
+    std::chrono::steady_clock::now()-start).count()};
+
+  std::cout << n_received << "/" << n_expected << " messages delivered in "
+            << seconds << " s: "
+            << n_received/seconds/1.0e6 << " M messages/s, "
+            << n_received*message_size/seconds/1.0e9 << " GB/s ("
+            << server.dropped_message_count() << " dropped)" << std::endl;
+
+  server.stop();
+  for (auto& subscriber : subscribers)
+  {
+    boost::asio::post(subscriber->Web_socket.get_executor(),
+                      [subscriber]()
+    {
+      boost::beast::get_lowest_layer(subscriber->Web_socket).close();
+    });
+  }
+  work.reset();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  return (all_connected && all_received) ? 0 : 1;
+}
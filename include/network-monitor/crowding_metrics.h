@@ -0,0 +1,166 @@
+#ifndef CROWDING_METRICS_H
+#define CROWDING_METRICS_H
+
+// Headers we've defined
+#include "network-monitor/passenger_event_parser.h"
+#include "network-monitor/station_index.h"
+
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief The sliding windows over which passenger rates are computed.
+  */
+  //===========================================================================
+  enum class CrowdingWindow : std::size_t
+  {
+    OneMinute,
+    FiveMinutes,
+    FifteenMinutes
+  };
+
+  //===========================================================================
+  /*! \brief Per-station and per-line passenger rates over sliding windows.
+
+      Passenger events are counted in fixed-width time buckets kept in a ring
+      that covers the longest window. Each bucket is one row of counters with
+      one column per (direction, dense station ID), so the whole network is a
+      single contiguous array per bucket.
+
+      Next to the ring we keep the running total of every window. Moving to a
+      new bucket subtracts the rows that fall out of each window from its
+      totals; these are plain loops over contiguous arrays that the compiler
+      vectorises, so one tick updates every station at once.
+  */
+  //===========================================================================
+  class CrowdingMetrics
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct the metrics for a network.
+
+        \param network_layout The parsed network-layout.json file; its
+                              "lines" list defines the per-line rates.
+        \param stations       The dense station IDs. It must outlive the
+                              metrics.
+        \param bucket_width   The time resolution of the windows. It should
+                              divide one minute.
+    */
+    //=========================================================================
+    CrowdingMetrics(const nlohmann::json& network_layout,
+                    const StationIndex& stations,
+                    std::chrono::seconds bucket_width=std::chrono::seconds(10));
+
+    //=========================================================================
+    /*! \brief Count a passenger event.
+
+        Events newer than the current bucket advance the windows first.
+        Late events are added to the bucket they belong to, as long as it is
+        still within the longest window.
+
+        \returns  false if the event is too old or its station is unknown.
+    */
+    //=========================================================================
+    bool record(const PassengerEvent& event);
+
+    //=========================================================================
+    /*! \brief Slide the windows forward so that they end at the given time.
+
+        Call this on a regular tick so that rates decay when no events
+        arrive. Times before the current bucket are ignored.
+
+        \param timestamp  Microseconds since the Unix epoch.
+    */
+    //=========================================================================
+    void advance_to(std::int64_t timestamp);
+
+    //=========================================================================
+    /*! \brief The passenger rate at a station, in events per minute.
+    */
+    //=========================================================================
+    double station_rate(std::uint32_t station,
+                        CrowdingWindow window,
+                        PassengerDirection direction) const;
+
+    //=========================================================================
+    /*! \brief The passenger rate across all the stations of a line, in events
+               per minute.
+
+        \param line The position of the line in the layout's "lines" list.
+    */
+    //=========================================================================
+    double line_rate(std::size_t line,
+                     CrowdingWindow window,
+                     PassengerDirection direction) const;
+
+    //=========================================================================
+    /*! \brief The event counts of every station over a window, indexed by
+               dense station ID.
+    */
+    //=========================================================================
+    const std::uint32_t* window_counts(CrowdingWindow window,
+                                       PassengerDirection direction) const;
+
+    //=========================================================================
+    /*! \brief The number of lines in the layout.
+    */
+    //=========================================================================
+    std::size_t line_count() const;
+
+    //=========================================================================
+    /*! \brief The line ID of a line, e.g. "line_000".
+    */
+    //=========================================================================
+    const std::string& line_id(std::size_t line) const;
+
+  private:
+    static constexpr std::size_t N_windows{3};
+
+    const StationIndex& Stations;
+    const std::int64_t Bucket_width;
+
+    // Number of buckets in each window; the ring holds the longest one.
+    std::array<std::size_t,N_windows> Window_buckets{};
+    std::size_t N_buckets{0};
+
+    // Width of a row: one column per direction and station
+    std::size_t N_columns{0};
+
+    // The ring of buckets, N_buckets rows of N_columns counters
+    std::vector<std::uint32_t> Buckets{};
+
+    // Running totals of each window, N_windows rows of N_columns counters
+    std::vector<std::uint32_t> Window_totals{};
+
+    // The bucket number (time/Bucket_width) of the newest row, and its row
+    std::int64_t Head_bucket{0};
+    std::size_t Head_row{0};
+    bool Started{false};
+
+    // Dense station IDs of each line, stored back to back
+    std::vector<std::string> Line_ids{};
+    std::vector<std::size_t> Line_offsets{};
+    std::vector<std::uint32_t> Line_stations{};
+
+    // Column of a station count
+    std::size_t column(std::uint32_t station,
+                       PassengerDirection direction) const;
+
+    // Row of the ring that is the given number of buckets older than the head
+    std::size_t row(std::size_t age) const;
+
+    // Move the head forward by one bucket
+    void advance_one();
+  };
+} // namespace NetworkMonitor
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef ENDPOINT_SELECTOR_H
+#define ENDPOINT_SELECTOR_H
+
+// Headers we've defined
+#include "network-monitor/websocket_client.h"
+
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/system/error_code.hpp>
+
+// Regular libraries
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief A WebSocket server the client can connect to.
+  */
+  //===========================================================================
+  struct WebSocketEndpoint
+  {
+    std::string url{};
+    std::string endpoint{};
+    std::string port{};
+  };
+
+  //===========================================================================
+  /*! \brief Tuning of the EndpointSelector.
+  */
+  //===========================================================================
+  struct EndpointSelectorOptions
+  {
+    // Number of pongs a candidate must answer to count as healthy
+    std::size_t probe_pings{5};
+
+    // Time between two pings while probing
+    std::chrono::milliseconds probe_interval{100};
+
+    // Candidates that have not answered every probe ping by then are
+    // unhealthy
+    std::chrono::milliseconds probe_timeout{5000};
+
+    // Time between two pings on the active connection
+    std::chrono::milliseconds ping_interval{1000};
+
+    // The active connection is degraded when its median round-trip time
+    // exceeds degradation_factor times the one measured when it was picked,
+    // over at least min_samples pongs, when it misses max_missed_pongs
+    // pongs in a row, or when it is lost.
+    double degradation_factor{2.0};
+    std::size_t min_samples{8};
+    std::size_t max_missed_pongs{3};
+  };
+
+  //===========================================================================
+  /*! \brief Connect to the lowest-latency healthy endpoint out of a list of
+             candidates, and move to a better one when it degrades.
+
+      On connect(), every candidate is probed with a short burst of WebSocket
+      pings and the client connects to the healthy one with the lowest median
+      round-trip time. The active connection keeps being pinged. When it
+      degrades, the other candidates are probed again and, if one of them is
+      now faster, the selector connects to it before closing the current
+      connection. on_connect is called again for the new connection, so the
+      user can repeat any protocol handshake (e.g. STOMP CONNECT).
+
+      If the active connection drops, on_disconnect is called and the
+      selector fails over straight away: every candidate, including the
+      lost one, is probed and the client connects to the best one. Until
+      then, send() fails.
+
+      Messages received on the old connection while the new one is being
+      set up are still delivered, so the user may see a few messages twice.
+
+      \note The io_context must be run from a single thread.
+  */
+  //===========================================================================
+  class EndpointSelector
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct an endpoint selector.
+
+        \note This constructor does not initiate a connection.
+
+        \param candidates The endpoints to choose from.
+        \param ioc        The io_context object. The user takes care of
+                          calling ioc.run().
+        \param ctx        The TLS context to setup TLS socket streams.
+        \param options    Probing and degradation settings.
+    */
+    //=========================================================================
+    EndpointSelector(std::vector<WebSocketEndpoint> candidates,
+                     boost::asio::io_context& ioc,
+                     boost::asio::ssl::context& ctx,
+                     EndpointSelectorOptions options = {});
+
+    //=========================================================================
+    /*! \brief Destructor
+    */
+    //=========================================================================
+    ~EndpointSelector();
+
+    //=========================================================================
+    /*! \brief Probe the candidates and connect to the best one.
+
+        \param on_connect     Called when the connection fails or succeeds,
+                              and again after every migration.
+        \param on_message     Called only when a message is successfully
+                              received. The message is an rvalue reference;
+                              ownership is passed to the receiver.
+        \param on_disconnect  Called when the active connection is closed by
+                              the server or due to a connection error.
+    */
+    //=========================================================================
+    void connect(
+      std::function<void (boost::system::error_code)> on_connect = nullptr,
+      std::function<void (boost::system::error_code,
+                          std::string&&)> on_message = nullptr,
+      std::function<void (boost::system::error_code)> on_disconnect = nullptr);
+
+    //=========================================================================
+    /*! \brief Send a text message on the active connection.
+
+        \param message  The message to send.
+        \param on_send  Called when a message is sent successfully or if it
+                        failed to send.
+    */
+    //=========================================================================
+    void send(
+      const std::string& message,
+      std::function<void (boost::system::error_code)> on_send = nullptr);
+
+    //=========================================================================
+    /*! \brief Stop probing and close the active connection.
+
+        \param on_close Called when the connection is closed, successfully or
+                        not.
+    */
+    //=========================================================================
+    void close(
+      std::function<void (boost::system::error_code)> on_close = nullptr);
+
+    //=========================================================================
+    /*! \brief The endpoint of the active connection, or nullptr.
+    */
+    //=========================================================================
+    const WebSocketEndpoint* active_endpoint() const;
+
+    //=========================================================================
+    /*! \brief The client of the active connection, or nullptr. Use it to
+               read the round-trip times of the connection.
+    */
+    //=========================================================================
+    const WebSocketClient* active_client() const;
+
+  private:
+    // A client and the candidate it connects to. Finished is set once the
+    // client has no operation left in flight, so that it can be destroyed.
+    struct Connection
+    {
+      std::size_t Candidate{0};
+      std::unique_ptr<WebSocketClient> Client{};
+      std::shared_ptr<bool> Finished{std::make_shared<bool>(false)};
+    };
+
+    const std::vector<WebSocketEndpoint> Candidates;
+    boost::asio::io_context& Ioc;
+    boost::asio::ssl::context& Ctx;
+    const EndpointSelectorOptions Options;
+
+    boost::asio::steady_timer Probe_timer;
+    boost::asio::steady_timer Monitor_timer;
+
+    // The connection in use, and the one replacing it
+    std::unique_ptr<Connection> Active{};
+    std::unique_ptr<Connection> Pending{};
+    std::chrono::microseconds Baseline_rtt{0};
+    bool Active_lost{false};
+
+    // The current probe round; a round number tells late callbacks apart.
+    std::vector<Connection> Probes{};
+    std::vector<std::chrono::microseconds> Probe_rtts{};
+    std::vector<bool> Probe_reported{};
+    std::size_t Probes_pending{0};
+    std::uint64_t Probe_round{0};
+    bool Probing{false};
+    bool Closing{false};
+
+    // Connections we are done with, kept until they are finished
+    std::vector<Connection> Retired{};
+
+    // Functions
+    std::function<void (boost::system::error_code)> OnConnectPt{nullptr};
+    std::function<void (boost::system::error_code,
+                        std::string&&)> OnMessagePt{nullptr};
+    std::function<void (boost::system::error_code)> OnDisconnectPt{nullptr};
+
+    void start_probe_round();
+    void on_probe_done(std::uint64_t round,
+                       std::size_t candidate,
+                       std::chrono::microseconds rtt);
+    void finish_probe_round();
+    void activate(std::size_t candidate);
+    void on_activated(const boost::system::error_code& ec);
+    void monitor(const boost::system::error_code& ec);
+  };
+} // namespace NetworkMonitor
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+// Headers we've defined
+#include "network-monitor/passenger_event_parser.h"
+
+// Regular libraries
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Settings of an EventLogWriter.
+  */
+  //===========================================================================
+  struct EventLogOptions
+  {
+    // Events per block; each block is written with a single write() call.
+    std::size_t block_events{65536};
+
+    // Blocks per segment file before the writer starts a new one
+    std::size_t segment_blocks{256};
+  };
+
+  //===========================================================================
+  /*! \brief Append-only, columnar log of passenger events.
+
+      A log is a directory of segment files, segment-000000.evlog,
+      segment-000001.evlog, and so on. A segment is a short header followed by
+      blocks of up to EventLogOptions::block_events events. Each block starts
+      with the minimum and maximum timestamp of its events, then stores one
+      column per field:
+
+      - timestamps, as the differences between consecutive events, zigzag
+        and LEB128-encoded, so that the usual gaps of a few milliseconds take
+        two or three bytes;
+      - dense station IDs, 1, 2 or 4 bytes wide depending on the largest ID
+        in the block;
+      - directions, one bit per event.
+
+      Events are buffered in memory until a block is full. The block is then
+      encoded and appended to the current segment with one write() call.
+      Station IDs refer to the StationIndex of the writer; readers must use
+      the same one to turn them back into station_id strings.
+
+      The writer is not thread-safe. Call it from the thread that delivers
+      the WebSocketClient messages, for example from the on_message handler
+      with append_message().
+  */
+  //===========================================================================
+  class EventLogWriter
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct a writer.
+
+        \param directory  The directory of the log. It is created on the first
+                          write if needed. Blocks already in it are kept; new
+                          events go to a new segment.
+        \param options    Block and segment sizes.
+    */
+    //=========================================================================
+    explicit EventLogWriter(std::filesystem::path directory,
+                            EventLogOptions options = {});
+
+    EventLogWriter(const EventLogWriter&) = delete;
+    EventLogWriter& operator=(const EventLogWriter&) = delete;
+
+    //=========================================================================
+    /*! \brief Destructor; writes the events still buffered.
+    */
+    //=========================================================================
+    ~EventLogWriter();
+
+    //=========================================================================
+    /*! \brief Append an event.
+
+        \returns  false if the event completed a block that could not be
+                  written. The block is dropped.
+    */
+    //=========================================================================
+    bool append(const PassengerEvent& event);
+
+    //=========================================================================
+    /*! \brief Decode and append the passenger events of a WebSocket message.
+
+        The message holds one or more STOMP frames, each ending with its NULL
+        octet. Frames that are not valid passenger events are skipped.
+
+        \param message    The message, as passed to the on_message handler of
+                          WebSocketClient.
+        \param parser     The parser of the frames.
+        \param n_dropped  If not null, set to the number of events lost
+                          because a block could not be written. Such a block
+                          may hold events of earlier calls too.
+        \returns          The number of events of the message for which
+                          append() succeeded.
+    */
+    //=========================================================================
+    std::size_t append_message(std::string_view message,
+                               const PassengerEventParser& parser,
+                               std::size_t* n_dropped=nullptr);
+
+    //=========================================================================
+    /*! \brief Write the buffered events as a (possibly short) block.
+
+        \returns  false if the block could not be written.
+    */
+    //=========================================================================
+    bool flush();
+
+    //=========================================================================
+    /*! \brief The number of events appended so far, written or buffered.
+               Dropped events are not counted.
+    */
+    //=========================================================================
+    std::size_t size() const;
+
+    //=========================================================================
+    /*! \brief The number of events lost so far because their block could not
+               be written.
+    */
+    //=========================================================================
+    std::size_t dropped_event_count() const;
+
+  private:
+    const std::filesystem::path Directory;
+    const EventLogOptions Options;
+
+    // The segment being written, or -1
+    int Fd{-1};
+    std::size_t Segment_number{0};
+    std::size_t Segment_blocks{0};
+
+    // The columns of the block being filled
+    std::vector<std::int64_t> Timestamps{};
+    std::vector<std::uint32_t> Stations{};
+    std::vector<PassengerDirection> Directions{};
+
+    // The encoded block, reused from one block to the next
+    std::string Block{};
+
+    std::size_t N_events{0};
+    std::size_t N_dropped{0};
+
+    bool open_segment();
+    void close_segment();
+  };
+
+  //===========================================================================
+  /*! \brief Events of one block that fall in the range of a scan, one array
+             per column.
+  */
+  //===========================================================================
+  struct EventLogBatch
+  {
+    std::size_t size{0};
+    const std::int64_t* timestamps{nullptr};
+    const std::uint32_t* stations{nullptr};
+    const PassengerDirection* directions{nullptr};
+  };
+
+  //===========================================================================
+  /*! \brief Memory-mapped, read-only view of an event log.
+
+      Opening a log maps its segment files and walks their block headers to
+      index the minimum and maximum timestamp of every block and segment.
+      Scans over a time range skip the segments and blocks outside it
+      without touching their pages, and decode the others one column at a
+      time.
+
+      Segments cut short, for example by a crash of the writer, keep their
+      complete blocks. Segments added after the reader was opened are not
+      seen; open a new reader to see them.
+  */
+  //===========================================================================
+  class EventLogReader
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct an empty reader.
+    */
+    //=========================================================================
+    EventLogReader() = default;
+
+    //=========================================================================
+    /*! \brief Map the segments of a log.
+
+        \param directory  The directory of the log. Segments that cannot be
+                          mapped or do not start with a valid header are
+                          ignored.
+    */
+    //=========================================================================
+    explicit EventLogReader(const std::filesystem::path& directory);
+
+    EventLogReader(const EventLogReader&) = delete;
+    EventLogReader& operator=(const EventLogReader&) = delete;
+    EventLogReader(EventLogReader&& other) noexcept;
+    EventLogReader& operator=(EventLogReader&& other) noexcept;
+
+    //=========================================================================
+    /*! \brief Destructor; unmaps the segments.
+    */
+    //=========================================================================
+    ~EventLogReader();
+
+    //=========================================================================
+    /*! \brief Visit the events in [from, to), one block at a time.
+
+        Events come in the order they were written. The arrays of a batch are
+        only valid during the call to on_batch. Blocks with no event in the
+        range are skipped.
+
+        \param from     The first timestamp of the range, in microseconds
+                        since the Unix epoch.
+        \param to       The timestamp past the end of the range.
+        \param on_batch Called with the events of each block in the range.
+        \returns        The number of events visited.
+    */
+    //=========================================================================
+    std::size_t scan(
+      std::int64_t from,
+      std::int64_t to,
+      const std::function<void (const EventLogBatch&)>& on_batch) const;
+
+    //=========================================================================
+    /*! \brief The number of events in the log.
+    */
+    //=========================================================================
+    std::size_t size() const;
+
+    //=========================================================================
+    /*! \brief The number of segments mapped.
+    */
+    //=========================================================================
+    std::size_t segment_count() const;
+
+    //=========================================================================
+    /*! \brief The number of blocks in all the segments.
+    */
+    //=========================================================================
+    std::size_t block_count() const;
+
+    //=========================================================================
+    /*! \brief The earliest timestamp in the log, 0 if it is empty.
+    */
+    //=========================================================================
+    std::int64_t min_time() const;
+
+    //=========================================================================
+    /*! \brief The latest timestamp in the log, 0 if it is empty.
+    */
+    //=========================================================================
+    std::int64_t max_time() const;
+
+  private:
+    // Where a block is in its segment, and its time range
+    struct Block
+    {
+      std::size_t Offset{0};
+      std::int64_t Min_time{0};
+      std::int64_t Max_time{0};
+    };
+
+    struct Segment
+    {
+      void* Mapping{nullptr};
+      std::size_t Mapping_size{0};
+      std::int64_t Min_time{0};
+      std::int64_t Max_time{0};
+      std::vector<Block> Blocks{};
+    };
+
+    std::vector<Segment> Segments{};
+    std::size_t N_events{0};
+
+    void unmap();
+  };
+} // namespace NetworkMonitor
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef HEAVY_HITTERS_H
+#define HEAVY_HITTERS_H
+
+// Regular libraries
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Approximate counts of a stream of keys in fixed memory.
+
+      A count-min sketch: depth rows of width counters, each row indexed by
+      its own hash of the key. The estimate of a key is the smallest of its
+      counters, which never undercounts and overcounts by at most
+      2*total/width with probability 1-2^-depth.
+  */
+  //===========================================================================
+  class CountMinSketch
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct an empty sketch.
+
+        \param width  The number of counters per row, rounded up to a power
+                      of two.
+        \param depth  The number of rows.
+    */
+    //=========================================================================
+    CountMinSketch(std::size_t width, std::size_t depth);
+
+    //=========================================================================
+    /*! \brief Count a key, and return its new estimate.
+    */
+    //=========================================================================
+    std::uint64_t add(std::uint64_t key, std::uint64_t count = 1);
+
+    //=========================================================================
+    /*! \brief The estimated count of a key.
+    */
+    //=========================================================================
+    std::uint64_t estimate(std::uint64_t key) const;
+
+    //=========================================================================
+    /*! \brief The sum of all the counts added so far.
+    */
+    //=========================================================================
+    std::uint64_t total() const;
+
+    //=========================================================================
+    /*! \brief Reset every counter to zero.
+    */
+    //=========================================================================
+    void clear();
+
+  private:
+    std::size_t Width_mask{0};
+    std::size_t Depth{0};
+    std::uint64_t Total{0};
+
+    // Depth rows of Width_mask+1 counters, one after the other
+    std::vector<std::uint64_t> Counters{};
+
+    std::size_t column(std::size_t row, std::uint64_t key) const;
+  };
+
+  //===========================================================================
+  /*! \brief Approximate top K of a stream of keys too large to count
+             exactly.
+
+      Keys are counted in a CountMinSketch, and the K keys with the highest
+      estimates are kept in a min-heap with an index from key to heap
+      position. A key replaces the root of the heap when its estimate
+      overtakes it. Memory is fixed by K and the sketch size, whatever the
+      number of distinct keys, e.g. edges keyed by (from << 32 | to).
+
+      Use TopKTracker instead when every key has a dense ID and the exact
+      counts fit in memory.
+  */
+  //===========================================================================
+  class HeavyHitters
+  {
+  public:
+    //=========================================================================
+    /*! \brief A key and its estimated count.
+    */
+    //=========================================================================
+    struct Entry
+    {
+      std::uint64_t key{0};
+      std::uint64_t count{0};
+    };
+
+    //=========================================================================
+    /*! \brief Construct an empty heavy hitters tracker.
+
+        \param k      The number of keys to keep track of.
+        \param width  The width of the sketch.
+        \param depth  The depth of the sketch.
+    */
+    //=========================================================================
+    HeavyHitters(std::size_t k,
+                 std::size_t width = 4096,
+                 std::size_t depth = 4);
+
+    //=========================================================================
+    /*! \brief Count a key.
+    */
+    //=========================================================================
+    void add(std::uint64_t key, std::uint64_t count = 1);
+
+    //=========================================================================
+    /*! \brief The K keys with the highest estimates, in no particular order.
+
+        \note The reference is invalidated by the next update.
+    */
+    //=========================================================================
+    const std::vector<Entry>& top() const;
+
+    //=========================================================================
+    /*! \brief The K keys with the highest estimates, highest first.
+    */
+    //=========================================================================
+    std::vector<Entry> sorted_top() const;
+
+    //=========================================================================
+    /*! \brief The underlying sketch, to estimate any key.
+    */
+    //=========================================================================
+    const CountMinSketch& sketch() const;
+
+    //=========================================================================
+    /*! \brief Forget every count, e.g. at the start of a new time window.
+    */
+    //=========================================================================
+    void clear();
+
+  private:
+    std::size_t K{0};
+    CountMinSketch Sketch;
+
+    // Min-heap of the candidates, and key -> heap position
+    std::vector<Entry> Heap{};
+    std::unordered_map<std::uint64_t, std::size_t> Positions{};
+
+    void sift_down(std::size_t position);
+    void sift_up(std::size_t position);
+  };
+} // namespace NetworkMonitor
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef PASSENGER_EVENT_GENERATOR_H
+#define PASSENGER_EVENT_GENERATOR_H
+
+// Headers we've defined
+#include "network-monitor/passenger_event_parser.h"
+#include "network-monitor/station_index.h"
+
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief A station that attracts more trips than the others.
+  */
+  //===========================================================================
+  struct DemandHotspot
+  {
+    std::string station_id{};
+
+    // Relative weight of the station as a trip origin or destination; the
+    // other stations weigh 1.
+    double weight{1.0};
+  };
+
+  //===========================================================================
+  /*! \brief A daily demand peak, shaped as a Gaussian bump over the base
+             demand.
+  */
+  //===========================================================================
+  struct RushHour
+  {
+    // Time of the peak, in hours after midnight UTC
+    double peak_hour{8.5};
+
+    // Standard deviation of the bump, in hours
+    double width_hours{1.0};
+
+    // Demand at the peak over the base demand, minus one: 2.0 triples it.
+    double extra_demand{2.0};
+  };
+
+  //===========================================================================
+  /*! \brief Settings of a PassengerEventGenerator.
+  */
+  //===========================================================================
+  struct PassengerEventGeneratorOptions
+  {
+    // Simulated time of the first trip, in microseconds since the Unix epoch
+    // (2020-11-01T00:00:00Z by default)
+    std::int64_t start_time{1604188800000000};
+
+    // Trips started per second of simulated time, outside rush hours
+    double trips_per_second{50.0};
+
+    // Longest wait on the platform before the train leaves, in seconds
+    double max_wait_seconds{300.0};
+
+    std::vector<DemandHotspot> hotspots{};
+    std::vector<RushHour> rush_hours{{8.5,1.0,2.0},{17.5,1.5,1.5}};
+
+    std::uint64_t seed{1};
+  };
+
+  //===========================================================================
+  /*! \brief Generate realistic passenger events from a network layout.
+
+      Each trip rides one route of the layout: it enters at one of the
+      route_stops and leaves at a later one, after waiting on the platform
+      and then travelling for the sum of the travel_times between them. So
+      every "in" event is followed, later in the stream, by the matching
+      "out" event. Routes with a missing travel time are not used.
+
+      Trips start as a Poisson process whose rate follows the rush hour
+      curves. Origins and destinations are drawn in proportion to the
+      station weights, so hotspots see more traffic.
+
+      Events come out in timestamp order. The generator runs on simulated
+      time, as fast as the caller pulls events. It is not thread-safe; use
+      one generator per thread, each with its own seed and a share of the
+      trip rate.
+  */
+  //===========================================================================
+  class PassengerEventGenerator
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct a generator.
+
+        \param network_layout The parsed network-layout.json file.
+        \param stations       The dense station IDs of the events. It must
+                              outlive the generator.
+        \param options        Demand settings.
+    */
+    //=========================================================================
+    PassengerEventGenerator(const nlohmann::json& network_layout,
+                            const StationIndex& stations,
+                            PassengerEventGeneratorOptions options = {});
+
+    //=========================================================================
+    /*! \brief Produce the next event.
+
+        \returns  false if the layout has no usable route.
+    */
+    //=========================================================================
+    bool next(PassengerEvent& event);
+
+    //=========================================================================
+    /*! \brief The demand multiplier at a time of day, 1 outside rush hours.
+
+        \param timestamp  Microseconds since the Unix epoch.
+    */
+    //=========================================================================
+    double demand(std::int64_t timestamp) const;
+
+    //=========================================================================
+    /*! \brief The number of routes trips are drawn from.
+    */
+    //=========================================================================
+    std::size_t route_count() const;
+
+  private:
+    // A passenger on a train, and when and where they will get off
+    struct PendingExit
+    {
+      std::int64_t Time{0};
+      std::uint32_t Station{0};
+    };
+
+    // A route: its stops, the travel time from the first stop to each stop
+    // in microseconds, and the running sum of the stop weights (one more
+    // entry than stops)
+    struct Route
+    {
+      std::vector<std::uint32_t> Stops{};
+      std::vector<std::int64_t> Arrivals{};
+      std::vector<double> Weight_sums{};
+    };
+
+    const PassengerEventGeneratorOptions Options;
+
+    std::vector<Route> Routes{};
+
+    // Running sum of the route weights, to pick a route
+    std::vector<double> Route_weight_sums{};
+
+    std::mt19937_64 Rng;
+    std::uniform_real_distribution<double> Uniform{0.0,1.0};
+    std::int64_t Next_trip{0};
+
+    // Min-heap on Time of the passengers still travelling
+    std::vector<PendingExit> Exits{};
+
+    // The index of a random entry of [first, last) of a running sum, drawn
+    // in proportion to the increments of the sum.
+    std::size_t draw(const std::vector<double>& sums,
+                     std::size_t first,
+                     std::size_t last);
+
+    void start_trip(PassengerEvent& event);
+  };
+
+  //===========================================================================
+  /*! \brief Append a passenger event as a STOMP MESSAGE frame, as published
+             on /passengers.
+
+      The body is the JSON object PassengerEventParser reads, and the frame
+      ends with its NULL octet, so frames can be concatenated.
+
+      \param event    The event.
+      \param stations The station index the event's dense ID refers to.
+      \param frame    The string to append to.
+      \param sent_at  If positive, the wall-clock time the frame is
+                      published at, in microseconds since the Unix epoch. It
+                      goes in a sent-at header, for subscribers to measure
+                      the feed latency.
+  */
+  //===========================================================================
+  void append_passenger_event_frame(const PassengerEvent& event,
+                                    const StationIndex& stations,
+                                    std::string& frame,
+                                    std::int64_t sent_at = 0);
+
+  //===========================================================================
+  /*! \brief Read the sent-at header of a passenger event frame.
+
+      \param frame    The STOMP frame.
+      \param sent_at  Microseconds since the Unix epoch, on success.
+      \returns        false if the frame has no valid sent-at header.
+  */
+  //===========================================================================
+  bool parse_passenger_event_frame_sent_at(std::string_view frame,
+                                           std::int64_t& sent_at);
+} // namespace NetworkMonitor
+
+#endif
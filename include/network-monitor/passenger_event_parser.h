@@ -0,0 +1,120 @@
+#ifndef PASSENGER_EVENT_PARSER_H
+#define PASSENGER_EVENT_PARSER_H
+
+// Headers we've defined
+#include "network-monitor/station_index.h"
+
+// Regular libraries
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Whether a passenger entered or left a station.
+  */
+  //===========================================================================
+  enum class PassengerDirection : std::uint8_t
+  {
+    In,
+    Out
+  };
+
+  //===========================================================================
+  /*! \brief A decoded passenger event.
+  */
+  //===========================================================================
+  struct PassengerEvent
+  {
+    // Microseconds since the Unix epoch (UTC)
+    std::int64_t timestamp{0};
+
+    // Dense station ID, see StationIndex
+    std::uint32_t station{StationIndex::npos};
+
+    PassengerDirection direction{PassengerDirection::In};
+  };
+
+  //===========================================================================
+  /*! \brief Schema-aware decoder for the passenger events published on
+             /network-events.
+
+      A passenger event is a flat JSON object such as:
+
+          {
+            "datetime": "2020-11-01T07:18:50.234000Z",
+            "passenger_event": "in",
+            "station_id": "station_042"
+          }
+
+      Instead of building a DOM, the parser jumps between string delimiters
+      (found 32 or 16 bytes at a time with AVX2 or SSE2, one byte at a time
+      elsewhere) and only decodes the three fields above. Unknown keys are
+      skipped. Field values containing escape sequences are rejected, since
+      the schema never produces them.
+  */
+  //===========================================================================
+  class PassengerEventParser
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct a parser.
+
+        \param stations The station index used to map station IDs to dense
+                        IDs. It must outlive the parser.
+    */
+    //=========================================================================
+    explicit PassengerEventParser(const StationIndex& stations);
+
+    //=========================================================================
+    /*! \brief Decode the JSON body of a passenger event.
+
+        \param body   The JSON object.
+        \param event  Filled in on success; unspecified otherwise.
+        \returns      false if the body is malformed, a field is missing, or
+                      the station is not in the station index.
+    */
+    //=========================================================================
+    bool parse(std::string_view body, PassengerEvent& event) const;
+
+    //=========================================================================
+    /*! \brief Decode a passenger event carried in a STOMP frame.
+
+        \param frame  The whole STOMP frame, as received from the WebSocket.
+                      The body starts after the first blank line and ends at
+                      the NULL octet or at the end of the frame.
+        \param event  Filled in on success; unspecified otherwise.
+    */
+    //=========================================================================
+    bool parse_stomp_frame(std::string_view frame,
+                           PassengerEvent& event) const;
+
+  private:
+    const StationIndex& Stations;
+  };
+
+  //===========================================================================
+  /*! \brief Parse an ISO 8601 UTC timestamp such as
+             "2020-11-01T07:18:50.234000Z".
+
+      \param text       The timestamp. The fractional part and the trailing
+                        'Z' are optional; digits past microseconds are
+                        truncated.
+      \param timestamp  Microseconds since the Unix epoch, on success.
+  */
+  //===========================================================================
+  bool parse_iso8601_timestamp(std::string_view text, std::int64_t& timestamp);
+
+  //===========================================================================
+  /*! \brief Append a timestamp in the format parse_iso8601_timestamp reads,
+             with microseconds, e.g. "2020-11-01T07:18:50.234000Z".
+
+      \param timestamp  Microseconds since the Unix epoch.
+      \param text       The string to append to.
+  */
+  //===========================================================================
+  void append_iso8601_timestamp(std::int64_t timestamp, std::string& text);
+} // namespace NetworkMonitor
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef PASSENGER_FEED_SERVER_H
+#define PASSENGER_FEED_SERVER_H
+
+// Headers we've defined
+#include "network-monitor/passenger_event_parser.h"
+#include "network-monitor/station_index.h"
+#include "network-monitor/websocket_server.h"
+
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/system/error_code.hpp>
+
+// Regular libraries
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Local stand-in for the live passenger event feed, to load test
+             the whole client pipeline on one machine.
+
+      Clients connect with WebSocketClient (over TLS, when the server has a
+      TLS context) and speak STOMP as with the live feed: a CONNECT (or
+      STOMP) frame is answered with CONNECTED, and a SUBSCRIBE frame to
+      /passengers, with a RECEIPT if it asked for one. From then on the
+      client receives the published events as STOMP MESSAGE frames that
+      PassengerEventParser::parse_stomp_frame reads.
+
+      Every frame carries a sent-at header with the wall-clock time it was
+      published at (see parse_passenger_event_frame_sent_at), so subscribers
+      can measure the latency of the feed.
+  */
+  //===========================================================================
+  class PassengerFeedServer
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct a plain WebSocket feed server.
+
+        \note This constructor does not start listening for connections.
+
+        \param ip             The IP address to listen on.
+        \param port           The port to listen on; 0 picks a free port.
+        \param ioc            The io_context object. The user takes care of
+                              calling ioc.run(), from one or more threads.
+        \param stations       The station index of the published events. It
+                              must outlive the server.
+        \param max_queue_size The maximum number of messages queued for one
+                              subscriber.
+        \param policy         What to do when a subscriber queue is full.
+    */
+    //=========================================================================
+    PassengerFeedServer(
+      const std::string& ip,
+      unsigned short port,
+      boost::asio::io_context& ioc,
+      const StationIndex& stations,
+      std::size_t max_queue_size=4096,
+      WebSocketServer::SlowClientPolicy policy=
+        WebSocketServer::SlowClientPolicy::DropMessages);
+
+    //=========================================================================
+    /*! \brief Construct a feed server over TLS.
+
+        \note This constructor does not start listening for connections.
+
+        \param ip             The IP address to listen on.
+        \param port           The port to listen on; 0 picks a free port.
+        \param ioc            The io_context object. The user takes care of
+                              calling ioc.run(), from one or more threads.
+        \param ctx            The TLS server context. It must outlive the
+                              server.
+        \param stations       The station index of the published events. It
+                              must outlive the server.
+        \param max_queue_size The maximum number of messages queued for one
+                              subscriber.
+        \param policy         What to do when a subscriber queue is full.
+    */
+    //=========================================================================
+    PassengerFeedServer(
+      const std::string& ip,
+      unsigned short port,
+      boost::asio::io_context& ioc,
+      boost::asio::ssl::context& ctx,
+      const StationIndex& stations,
+      std::size_t max_queue_size=4096,
+      WebSocketServer::SlowClientPolicy policy=
+        WebSocketServer::SlowClientPolicy::DropMessages);
+
+    //=========================================================================
+    /*! \brief Start accepting clients.
+
+        \param on_subscribe   Called when a client fails its handshake, or
+                              subscribes to /passengers.
+        \param on_unsubscribe Called when a subscriber disconnects or is
+                              disconnected.
+        \returns              An error if the server could not listen on the
+                              requested address.
+    */
+    //=========================================================================
+    boost::system::error_code run(
+      std::function<void (boost::system::error_code)> on_subscribe = nullptr,
+      std::function<void (boost::system::error_code)> on_unsubscribe = nullptr);
+
+    //=========================================================================
+    /*! \brief Stop accepting clients and disconnect the current ones.
+    */
+    //=========================================================================
+    void stop();
+
+    //=========================================================================
+    /*! \brief Publish an event as one WebSocket message, as the live feed
+               does.
+
+        \note This function is thread-safe.
+    */
+    //=========================================================================
+    void publish(const PassengerEvent& event);
+
+    //=========================================================================
+    /*! \brief Publish several events as consecutive STOMP frames in one
+               WebSocket message.
+
+        This amortises the per-message cost, but subscribers must split the
+        message on the NULL octets: parse_stomp_frame only reads the first
+        frame.
+
+        \note This function is thread-safe.
+    */
+    //=========================================================================
+    void publish(const std::vector<PassengerEvent>& events);
+
+    //=========================================================================
+    /*! \brief The number of clients subscribed to /passengers.
+    */
+    //=========================================================================
+    std::size_t subscriber_count() const;
+
+    //=========================================================================
+    /*! \brief The number of messages dropped because a subscriber queue was
+               full. Only final once pending_message_count() is zero.
+    */
+    //=========================================================================
+    std::size_t dropped_message_count() const;
+
+    //=========================================================================
+    /*! \brief The number of messages queued or being written, summed over
+               the subscribers.
+    */
+    //=========================================================================
+    std::size_t pending_message_count() const;
+
+    //=========================================================================
+    /*! \brief The port the server listens on, once run() has succeeded.
+    */
+    //=========================================================================
+    unsigned short port() const;
+
+  private:
+    const StationIndex& Stations;
+    WebSocketServer Server;
+  };
+} // namespace NetworkMonitor
+
+#endif
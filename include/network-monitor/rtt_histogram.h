@@ -0,0 +1,84 @@
+#ifndef RTT_HISTOGRAM_H
+#define RTT_HISTOGRAM_H
+
+// Regular libraries
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Rolling histogram of round-trip times.
+
+      The histogram covers the most recent samples only: once it holds
+      window samples, each new sample evicts the oldest one. Samples are
+      counted in logarithmic buckets with four sub-buckets per power of two,
+      so percentiles are accurate to about 12% and cost a walk over a few
+      hundred counters, whatever the window size.
+  */
+  //===========================================================================
+  class RttHistogram
+  {
+  public:
+    //=========================================================================
+    /*! \brief Construct an empty histogram.
+
+        \param window The number of recent samples the histogram covers.
+    */
+    //=========================================================================
+    explicit RttHistogram(std::size_t window=128);
+
+    //=========================================================================
+    /*! \brief Add a sample, evicting the oldest one if the window is full.
+    */
+    //=========================================================================
+    void record(std::chrono::microseconds rtt);
+
+    //=========================================================================
+    /*! \brief Remove every sample.
+    */
+    //=========================================================================
+    void clear();
+
+    //=========================================================================
+    /*! \brief The number of samples in the window.
+    */
+    //=========================================================================
+    std::size_t count() const;
+
+    //=========================================================================
+    /*! \brief Estimate a percentile of the samples in the window.
+
+        \param fraction The percentile as a fraction, e.g. 0.5 for the
+                        median or 0.99 for the 99th percentile.
+        \returns        Zero if the histogram is empty.
+    */
+    //=========================================================================
+    std::chrono::microseconds percentile(double fraction) const;
+
+    //=========================================================================
+    /*! \brief The most recent sample, or zero if the histogram is empty.
+    */
+    //=========================================================================
+    std::chrono::microseconds last() const;
+
+  private:
+    static constexpr std::size_t N_buckets{256};
+
+    // Ring of the samples in the window, in microseconds
+    std::vector<std::int64_t> Samples{};
+    std::size_t Next{0};
+    std::size_t Count{0};
+
+    // Number of samples of the window in each bucket
+    std::array<std::uint32_t,N_buckets> Counts{};
+
+    // Bucket of a sample, and the value reported for a bucket
+    static std::size_t bucket(std::int64_t microseconds);
+    static std::int64_t bucket_value(std::size_t bucket);
+  };
+} // namespace NetworkMonitor
+
+#endif
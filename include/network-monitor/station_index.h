@@ -0,0 +1,105 @@
+#ifndef STATION_INDEX_H
+#define STATION_INDEX_H
+
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Map station IDs to dense integers through a perfect hash.
+
+      The index is built once from the network layout. Each station ID gets
+      the position it first appears at in the layout's "stations" list, so
+      the dense IDs can be used directly to index per-station arrays.
+
+      Lookups hash the key once, read one displacement value and one slot,
+      and confirm the match with a single string comparison. Unknown keys
+      return StationIndex::npos.
+  */
+  //===========================================================================
+  class StationIndex
+  {
+  public:
+    //=========================================================================
+    /*! \brief Value returned by find() when the station ID is unknown.
+    */
+    //=========================================================================
+    static constexpr std::uint32_t npos{0xFFFFFFFF};
+
+    //=========================================================================
+    /*! \brief Construct an empty index.
+    */
+    //=========================================================================
+    StationIndex() = default;
+
+    //=========================================================================
+    /*! \brief Construct the index from a list of station IDs.
+
+        \param station_ids  The station IDs; the dense ID of a station is its
+                            position in this list. Duplicates are ignored.
+    */
+    //=========================================================================
+    explicit StationIndex(const std::vector<std::string>& station_ids);
+
+    //=========================================================================
+    /*! \brief Construct the index from the "stations" list of a network
+               layout.
+
+        \param network_layout The parsed network-layout.json file. If it has
+                              no "stations" list, the index is empty.
+    */
+    //=========================================================================
+    explicit StationIndex(const nlohmann::json& network_layout);
+
+    //=========================================================================
+    /*! \brief Get the dense ID of a station.
+
+        \param station_id The station ID, e.g. "station_042".
+        \returns          The dense ID, or StationIndex::npos.
+    */
+    //=========================================================================
+    std::uint32_t find(std::string_view station_id) const;
+
+    //=========================================================================
+    /*! \brief Get the station ID corresponding to a dense ID.
+
+        \param index  A dense ID in [0,size()).
+    */
+    //=========================================================================
+    const std::string& station_id(std::uint32_t index) const;
+
+    //=========================================================================
+    /*! \brief The number of stations in the index.
+    */
+    //=========================================================================
+    std::size_t size() const;
+
+  private:
+    // The station IDs, in dense ID order
+    std::vector<std::string> Station_ids{};
+
+    // One displacement value per bucket of keys
+    std::vector<std::uint32_t> Pilots{};
+
+    // Slot -> dense ID (npos for empty slots)
+    std::vector<std::uint32_t> Slots{};
+
+    // Build the displacement and slot tables from Station_ids
+    void build();
+
+    // Slot of a key with the given hash, using the displacement of its bucket
+    std::size_t slot(std::uint64_t hash, std::uint32_t pilot) const;
+
+    // Bucket of a key with the given hash
+    std::size_t bucket(std::uint64_t hash) const;
+  };
+} // namespace NetworkMonitor
+
+#endif
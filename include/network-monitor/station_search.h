@@ -0,0 +1,175 @@
+#ifndef STATION_SEARCH_H
+#define STATION_SEARCH_H
+
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief A station that matches a search query.
+
+      The views point into the StationSearch and stay valid until its next
+      reload().
+  */
+  //===========================================================================
+  struct StationMatch
+  {
+    std::string_view station_id{};
+    std::string_view name{};
+
+    // Number of typos between the query and the name; 0 for prefix matches
+    unsigned distance{0};
+  };
+
+  //===========================================================================
+  /*! \brief Search-as-you-type index over the station names of a layout.
+
+      Names are normalised (lower case, punctuation dropped, "&" read as
+      "and") and every word of a name starts a key, so "kent" finds both
+      "Kenton" and "South Kenton". The keys form a trie stored in a flat node
+      array; each node carries the best few stations below it, ranked by
+      whether the match is at the start of the name and then by name length.
+      A prefix query walks one node per character and copies that list out.
+
+      Typo-tolerant queries go through a trigram index instead: the posting
+      lists of the query trigrams vote for candidate stations, and the best
+      candidates are ranked by the edit distance between the query and the
+      closest part of their name.
+
+      The trie is split by the first character of the keys. reload() only
+      re-indexes the stations that were added, renamed or removed, and only
+      rebuilds the parts of the trie holding a word of their old or new
+      name, e.g. those under "k", "u" and "s" to rename "Kenton Underground
+      Station".
+  */
+  //===========================================================================
+  class StationSearch
+  {
+  public:
+    //=========================================================================
+    /*! \brief Build the index of a layout.
+
+        \param network_layout   The parsed network-layout.json file.
+        \param max_suggestions  The most results a prefix query can return.
+    */
+    //=========================================================================
+    StationSearch(const nlohmann::json& network_layout,
+                  std::size_t max_suggestions = 10);
+
+    //=========================================================================
+    /*! \brief Bring the index up to date with a new version of the layout.
+
+        \returns  The number of stations added, renamed or removed.
+    */
+    //=========================================================================
+    std::size_t reload(const nlohmann::json& network_layout);
+
+    //=========================================================================
+    /*! \brief The stations with a word starting with the query, best first.
+    */
+    //=========================================================================
+    std::vector<StationMatch> prefix_search(std::string_view query,
+                                            std::size_t limit = 10) const;
+
+    //=========================================================================
+    /*! \brief The stations whose name is closest to the query, allowing
+               about one typo every four characters, best first.
+
+        Only the first 64 characters of the query are used.
+    */
+    //=========================================================================
+    std::vector<StationMatch> fuzzy_search(std::string_view query,
+                                           std::size_t limit = 10) const;
+
+    //=========================================================================
+    /*! \brief Prefix matches, completed with fuzzy matches if there are
+               fewer than limit of them.
+    */
+    //=========================================================================
+    std::vector<StationMatch> search(std::string_view query,
+                                     std::size_t limit = 10) const;
+
+    //=========================================================================
+    /*! \brief The number of stations in the index.
+    */
+    //=========================================================================
+    std::size_t size() const;
+
+  private:
+    // A station and its index data. Slots of removed stations are reused.
+    struct Slot
+    {
+      std::string Station_id{};
+      std::string Name{};
+      std::string Normalized{};
+      std::vector<std::uint32_t> Trigrams{};
+      bool Live{false};
+    };
+
+    // A trie node: its children are Nodes[First_child, First_child +
+    // N_children), sorted by label, and its best stations are
+    // Suggestions[First_suggestion, First_suggestion + N_suggestions).
+    struct Node
+    {
+      std::uint32_t First_child{0};
+      std::uint32_t First_suggestion{0};
+      std::uint16_t N_children{0};
+      std::uint8_t N_suggestions{0};
+      char Label{0};
+    };
+
+    // The part of the trie under one first character: its root is
+    // Nodes[0], which stands for that character.
+    struct Shard
+    {
+      std::vector<Node> Nodes{};
+      std::vector<std::uint32_t> Suggestions{};
+    };
+
+    // A trie key: the normalised name of a slot from one of its words on
+    struct Key
+    {
+      std::string_view Text{};
+      std::uint32_t Index{0};
+      std::uint32_t Word{0};
+    };
+
+    const std::size_t Max_suggestions;
+
+    std::vector<Slot> Slots{};
+    std::vector<std::uint32_t> Free_slots{};
+    std::unordered_map<std::string, std::uint32_t> Slot_of_station{};
+    std::size_t N_live{0};
+
+    // Trigram -> slots whose name contains it
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> Postings{};
+
+    // The trie, by first character, and the shards to rebuild
+    std::array<Shard,256> Shards{};
+    std::bitset<256> Dirty_shards{};
+
+    void index_slot(std::uint32_t slot);
+    void unindex_slot(std::uint32_t slot);
+    void mark_dirty(std::uint32_t slot);
+    void build_shard(unsigned char first);
+    void build_node(Shard& shard,
+                    std::uint32_t node,
+                    const std::vector<Key>& keys,
+                    std::size_t begin,
+                    std::size_t end,
+                    std::size_t depth);
+    StationMatch match(std::uint32_t slot, unsigned distance) const;
+  };
+} // namespace NetworkMonitor
+
+#endif
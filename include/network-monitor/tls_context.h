@@ -0,0 +1,63 @@
+#ifndef TLS_CONTEXT_H
+#define TLS_CONTEXT_H
+
+// Boost-specific libraries
+#include <boost/asio/ssl.hpp>
+
+// Regular libraries
+#include <filesystem>
+#include <memory>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Create a TLS client context that trusts the CAs of a cacert.pem
+             file.
+
+      The file is parsed the first time it is requested and the resulting
+      certificate store is shared, reference-counted, by every context made
+      from it afterwards, so that the 3,000+ line bundle is parsed once per
+      process rather than once per context. Contexts may be created from any
+      thread.
+
+      The contexts verify the peer certificate against the CAs, and fail
+      the TLS handshake if it does not chain to one of them. The host name
+      is not part of the context: the connection checks it, as
+      WebSocketClient does for its URL.
+
+      The certificate store is shared: do not add certificates to it through
+      one of the contexts.
+
+      \param ca_cert_file The path to a cacert.pem file.
+      \returns            nullptr if the CA file could not be loaded.
+  */
+  //===========================================================================
+  std::shared_ptr<boost::asio::ssl::context> make_tls_client_context(
+    const std::filesystem::path& ca_cert_file);
+
+  //===========================================================================
+  /*! \brief Create a TLS server context from a certificate chain and its
+             private key, both in PEM format.
+
+      \param cert_chain_file  The server certificate, followed by any
+                              intermediate certificates.
+      \param private_key_file The private key of the server certificate.
+      \returns                nullptr if either file could not be loaded.
+  */
+  //===========================================================================
+  std::shared_ptr<boost::asio::ssl::context> make_tls_server_context(
+    const std::filesystem::path& cert_chain_file,
+    const std::filesystem::path& private_key_file);
+
+  //===========================================================================
+  /*! \brief Whether this build of OpenSSL can use kernel TLS.
+
+      kTLS only engages for TLS sessions that read and write a socket
+      directly. Boost.Asio's ssl::stream, and so WebSocketClient, runs TLS
+      through memory BIOs and cannot use it.
+  */
+  //===========================================================================
+  bool ktls_supported();
+} // namespace NetworkMonitor
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef TOP_K_TRACKER_H
+#define TOP_K_TRACKER_H
+
+// Regular libraries
+#include <cstdint>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Keep the K most loaded items up to date as their loads change.
+
+      Items are dense IDs in [0,n_items), e.g. the dense station IDs of a
+      StationIndex. The K most loaded items sit in a min-heap and all the
+      others in a max-heap, with an index from item to heap position. A load
+      update re-heapifies the item where it is and, if it crossed the
+      boundary, swaps the roots of the two heaps: O(log n) per update.
+
+      The top K items are the storage of the first heap, so reading them is
+      O(K) and never touches the other items. Ties are broken by the lower
+      item ID.
+  */
+  //===========================================================================
+  class TopKTracker
+  {
+  public:
+    //=========================================================================
+    /*! \brief An item and its load.
+    */
+    //=========================================================================
+    struct Entry
+    {
+      std::uint32_t id{0};
+      std::int64_t load{0};
+    };
+
+    //=========================================================================
+    /*! \brief Construct a tracker where every item has a load of zero.
+
+        \param n_items  The number of items.
+        \param k        The number of items to keep track of.
+    */
+    //=========================================================================
+    TopKTracker(std::size_t n_items, std::size_t k);
+
+    //=========================================================================
+    /*! \brief Set the load of an item.
+    */
+    //=========================================================================
+    void set(std::uint32_t id, std::int64_t load);
+
+    //=========================================================================
+    /*! \brief Add to (or, with a negative delta, subtract from) the load of
+               an item.
+    */
+    //=========================================================================
+    void add(std::uint32_t id, std::int64_t delta);
+
+    //=========================================================================
+    /*! \brief The current load of an item.
+    */
+    //=========================================================================
+    std::int64_t load(std::uint32_t id) const;
+
+    //=========================================================================
+    /*! \brief The K most loaded items, in no particular order.
+
+        \note The reference is invalidated by the next update.
+    */
+    //=========================================================================
+    const std::vector<Entry>& top() const;
+
+    //=========================================================================
+    /*! \brief The K most loaded items, most loaded first.
+    */
+    //=========================================================================
+    std::vector<Entry> sorted_top() const;
+
+  private:
+    // Heap positions are tagged with the heap they refer to.
+    static constexpr std::uint32_t In_top{0x80000000};
+
+    // Min-heap of the top K items, and max-heap of the others
+    std::vector<Entry> Top{};
+    std::vector<Entry> Rest{};
+
+    // Item -> heap position, with In_top set for the items in Top
+    std::vector<std::uint32_t> Positions{};
+
+    std::vector<Entry>& heap(bool top);
+    void place(bool top, std::size_t position);
+    void sift_up(bool top, std::size_t position);
+    void sift_down(bool top, std::size_t position);
+    void update(std::uint32_t id, std::int64_t load);
+  };
+} // namespace NetworkMonitor
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef TRAVEL_TIME_MATRIX_H
+#define TRAVEL_TIME_MATRIX_H
+
+// Headers we've defined
+#include "network-monitor/station_index.h"
+
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace NetworkMonitor
+{
+  //===========================================================================
+  /*! \brief Shortest travel time between every pair of stations.
+
+      The matrix is computed once from the "travel_times" and "route_stops"
+      of the network layout, with one shortest-path search per source
+      station spread over several threads. Travel times are in minutes and
+      transfers between lines are free.
+
+      Times are stored as uint16_t in square tiles of block_size x block_size
+      cells, so that the rows of nearby stations share cache lines. The
+      matrix can be saved to a file and memory-mapped back, which makes
+      loading it at startup free.
+  */
+  //===========================================================================
+  class TravelTimeMatrix
+  {
+  public:
+    //=========================================================================
+    /*! \brief The travel time between stations with no path between them.
+    */
+    //=========================================================================
+    static constexpr std::uint16_t unreachable{0xFFFF};
+
+    //=========================================================================
+    /*! \brief The side of the square tiles the matrix is stored in.
+    */
+    //=========================================================================
+    static constexpr std::size_t block_size{16};
+
+    //=========================================================================
+    /*! \brief Construct an empty matrix.
+    */
+    //=========================================================================
+    TravelTimeMatrix() = default;
+
+    //=========================================================================
+    /*! \brief Compute the matrix of a network.
+
+        \param network_layout The parsed network-layout.json file.
+        \param stations       The dense station IDs of the network; they
+                              index the rows and columns of the matrix.
+        \param n_threads      The number of threads to use; 0 uses one per
+                              hardware thread.
+    */
+    //=========================================================================
+    TravelTimeMatrix(const nlohmann::json& network_layout,
+                     const StationIndex& stations,
+                     unsigned n_threads=0);
+
+    TravelTimeMatrix(const TravelTimeMatrix&) = delete;
+    TravelTimeMatrix& operator=(const TravelTimeMatrix&) = delete;
+    TravelTimeMatrix(TravelTimeMatrix&& other) noexcept;
+    TravelTimeMatrix& operator=(TravelTimeMatrix&& other) noexcept;
+
+    //=========================================================================
+    /*! \brief Destructor; unmaps the file the matrix was loaded from, if
+               any.
+    */
+    //=========================================================================
+    ~TravelTimeMatrix();
+
+    //=========================================================================
+    /*! \brief The shortest travel time from one station to another, in
+               minutes, or TravelTimeMatrix::unreachable.
+
+        \param from The dense ID of the departure station.
+        \param to   The dense ID of the arrival station.
+    */
+    //=========================================================================
+    std::uint16_t travel_time(std::uint32_t from, std::uint32_t to) const
+    {
+      return Cells[cell(from,to)];
+    }
+
+    //=========================================================================
+    /*! \brief The number of stations, i.e. rows and columns, in the matrix.
+    */
+    //=========================================================================
+    std::size_t size() const;
+
+    //=========================================================================
+    /*! \brief Save the matrix to a file.
+
+        \param destination  The full path and filename of the output file.
+                            The path to the file must exist.
+        \param stations     The station index the matrix was built with. A
+                            fingerprint of it is stored in the file.
+    */
+    //=========================================================================
+    bool save(const std::filesystem::path& destination,
+              const StationIndex& stations) const;
+
+    //=========================================================================
+    /*! \brief Memory-map a matrix saved with save().
+
+        \param source   The path to the file to load.
+        \param stations The station index to use the matrix with. It must
+                        list the same stations, in the same order, as the
+                        one the matrix was built with.
+        \returns        An empty matrix if the file cannot be mapped, is
+                        malformed, or was built for other stations.
+    */
+    //=========================================================================
+    static TravelTimeMatrix load(const std::filesystem::path& source,
+                                 const StationIndex& stations);
+
+  private:
+    std::size_t N_stations{0};
+    std::size_t N_blocks{0};
+
+    // The cells, either owned or in a read-only mapping of a file
+    std::vector<std::uint16_t> Data{};
+    const std::uint16_t* Cells{nullptr};
+    void* Mapping{nullptr};
+    std::size_t Mapping_size{0};
+
+    // Size the tile grid for a number of stations
+    void resize(std::size_t n_stations);
+
+    // Position of a cell: tile first, then row and column within the tile
+    std::size_t cell(std::size_t from, std::size_t to) const
+    {
+      return ((from/block_size)*N_blocks+to/block_size)*block_size*block_size+
+        (from%block_size)*block_size+to%block_size;
+    }
+  };
+} // namespace NetworkMonitor
+
+#endif
@@ -7,7 +7,12 @@
 #include <boost/system/error_code.hpp>
 #include <boost/beast/ssl.hpp>
 
+// Headers we've defined
+#include "network-monitor/rtt_histogram.h"
+
 // Regular libraries
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -31,7 +36,9 @@ namespace NetworkMonitor
         \param port     The port on the server.
         \param ioc      The io_context object. The user takes care of calling
                         ioc.run().
-        \param ctx      The TLS context to setup a TLS socket stream.
+        \param ctx      The TLS context to setup a TLS socket stream. If it
+                        verifies the peer, the server certificate must
+                        also be valid for url.
     */
     //=========================================================================
     WebSocketClient(const std::string& url,
@@ -85,6 +92,46 @@ namespace NetworkMonitor
     void close(
       std::function<void (boost::system::error_code)> on_close = nullptr);
 
+    //=========================================================================
+    /*! \brief Measure the round-trip time of the connection with WebSocket
+               ping/pong frames.
+
+        One ping is sent per interval, starting as soon as the connection is
+        open. A ping still unanswered when the next one is due counts as a
+        missed pong.
+        If the previous ping has not even been written yet, no new ping is
+        sent and that tick also counts as a missed pong.
+
+        \param interval The time between two pings.
+        \param on_rtt   Called with the round-trip time of every pong.
+    */
+    //=========================================================================
+    void start_ping(
+      std::chrono::milliseconds interval,
+      std::function<void (std::chrono::microseconds)> on_rtt = nullptr);
+
+    //=========================================================================
+    /*! \brief Stop sending pings.
+    */
+    //=========================================================================
+    void stop_ping();
+
+    //=========================================================================
+    /*! \brief The round-trip times of the most recent pongs.
+
+        \note Only read this from the io_context thread, e.g. in a callback.
+    */
+    //=========================================================================
+    const RttHistogram& rtt_histogram() const;
+
+    //=========================================================================
+    /*! \brief The number of pings in a row that did not get a pong.
+
+        \note Only read this from the io_context thread, e.g. in a callback.
+    */
+    //=========================================================================
+    std::size_t missed_pongs() const;
+
   private:
     const std::string& Url;
     const std::string& Endpoint;
@@ -97,11 +144,22 @@ namespace NetworkMonitor
     > Web_socket;
     boost::beast::flat_buffer Read_buffer;
 
+    // Ping/pong round-trip time measurement
+    boost::asio::steady_timer Ping_timer;
+    std::chrono::milliseconds Ping_interval{0};
+    std::chrono::steady_clock::time_point Ping_sent_at{};
+    std::uint64_t Ping_sequence{0};
+    bool Pong_pending{false};
+    bool Ping_in_flight{false};
+    std::size_t Missed_pongs{0};
+    RttHistogram Rtt{32};
+
     // Functions
     std::function<void (boost::system::error_code)> OnConnectPt{nullptr};
     std::function<void (boost::system::error_code,
                         std::string&&)> OnMessagePt{nullptr};
     std::function<void (boost::system::error_code)> OnDisconnectPt{nullptr};
+    std::function<void (std::chrono::microseconds)> OnRttPt{nullptr};
 
     // Callback handlers to manage the outcome of this class' public members
     void on_resolve(const boost::system::error_code& ec,
@@ -111,6 +169,9 @@ namespace NetworkMonitor
     void on_handshake(const boost::system::error_code& ec);
     void listen_to_incoming_message(const boost::system::error_code& ec);
     void on_read(const boost::system::error_code& ec, size_t nBytes);
+    void send_ping(const boost::system::error_code& ec);
+    void on_control_frame(boost::beast::websocket::frame_type kind,
+                          boost::beast::string_view payload);
   };
 } // namespace NetworkMonitor
 
@@ -0,0 +1,186 @@
+#ifndef WEBSOCKET_SERVER_H
+#define WEBSOCKET_SERVER_H
+
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/system/error_code.hpp>
+
+// Regular libraries
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace NetworkMonitor
+{
+  // Defined in websocket_server.cc
+  class WebSocketSession;
+  struct WebSocketSubscribers;
+
+  //===========================================================================
+  /*! \brief WebSocket server that publishes the same messages to every
+             connected subscriber.
+
+      A broadcast is serialised once into an immutable buffer that all the
+      subscribers share; each subscriber only queues a reference to it. Every
+      subscriber has a bounded send queue. When a subscriber does not keep
+      up, the server either drops the messages that do not fit in its queue
+      or disconnects it, depending on the SlowClientPolicy.
+
+      By default a client becomes a subscriber as soon as its WebSocket
+      handshake completes, and the server only reads from it to notice when
+      it disconnects. With an on_request handler, the client must first ask
+      to subscribe (e.g. with a STOMP SUBSCRIBE frame).
+
+      The server speaks plain WebSocket, or WebSocket over TLS when it is
+      given a TLS context.
+  */
+  //===========================================================================
+  class WebSocketServer
+  {
+  public:
+    //=========================================================================
+    /*! \brief What to do with a subscriber whose send queue is full.
+    */
+    //=========================================================================
+    enum class SlowClientPolicy
+    {
+      DropMessages,
+      Disconnect
+    };
+
+    //=========================================================================
+    /*! \brief Construct a WebSocket server.
+
+        \note This constructor does not start listening for connections.
+
+        \param ip             The IP address to listen on.
+        \param port           The port to listen on; 0 picks a free port.
+        \param ioc            The io_context object. The user takes care of
+                              calling ioc.run(), from one or more threads.
+        \param max_queue_size The maximum number of messages queued for one
+                              subscriber, including the one being sent.
+        \param policy         What to do when a subscriber queue is full.
+    */
+    //=========================================================================
+    WebSocketServer(const std::string& ip,
+                    unsigned short port,
+                    boost::asio::io_context& ioc,
+                    std::size_t max_queue_size=256,
+                    SlowClientPolicy policy=SlowClientPolicy::Disconnect);
+
+    //=========================================================================
+    /*! \brief Construct a WebSocket server over TLS.
+
+        \note This constructor does not start listening for connections.
+
+        \param ip             The IP address to listen on.
+        \param port           The port to listen on; 0 picks a free port.
+        \param ioc            The io_context object. The user takes care of
+                              calling ioc.run(), from one or more threads.
+        \param ctx            The TLS server context, with the certificate
+                              of the server. It must outlive the server.
+        \param max_queue_size The maximum number of messages queued for one
+                              subscriber, including the one being sent.
+        \param policy         What to do when a subscriber queue is full.
+    */
+    //=========================================================================
+    WebSocketServer(const std::string& ip,
+                    unsigned short port,
+                    boost::asio::io_context& ioc,
+                    boost::asio::ssl::context& ctx,
+                    std::size_t max_queue_size=256,
+                    SlowClientPolicy policy=SlowClientPolicy::Disconnect);
+
+    //=========================================================================
+    /*! \brief Destructor
+    */
+    //=========================================================================
+    ~WebSocketServer();
+
+    //=========================================================================
+    /*! \brief Start accepting subscribers.
+
+        \param on_subscribe   Called when a client fails its handshake, or
+                              becomes a subscriber.
+        \param on_unsubscribe Called when a subscriber disconnects or is
+                              disconnected.
+        \param on_request     Called with every message a client sends
+                              before it is a subscriber. A non-empty reply
+                              is sent back to that client only. Return true
+                              to make the client a subscriber. It may run on
+                              several threads at once.
+        \returns              An error if the server could not listen on the
+                              requested address.
+    */
+    //=========================================================================
+    boost::system::error_code run(
+      std::function<void (boost::system::error_code)> on_subscribe = nullptr,
+      std::function<void (boost::system::error_code)> on_unsubscribe = nullptr,
+      std::function<bool (const std::string& request,
+                          std::string& reply)> on_request = nullptr);
+
+    //=========================================================================
+    /*! \brief Stop accepting subscribers and disconnect the current ones.
+    */
+    //=========================================================================
+    void stop();
+
+    //=========================================================================
+    /*! \brief Send a text message to every subscriber.
+
+        \note This function is thread-safe.
+
+        \param message  The message. It is moved into a buffer shared by all
+                        the subscribers; it is not copied per subscriber.
+    */
+    //=========================================================================
+    void broadcast(std::string message);
+
+    //=========================================================================
+    /*! \brief The number of connected subscribers.
+    */
+    //=========================================================================
+    std::size_t subscriber_count() const;
+
+    //=========================================================================
+    /*! \brief The number of messages dropped because a subscriber queue was
+               full.
+    */
+    //=========================================================================
+    std::size_t dropped_message_count() const;
+
+    //=========================================================================
+    /*! \brief The number of messages, summed over the subscribers, that are
+               queued or being written.
+
+        Once it drops to zero, dropped_message_count() is final for the
+        messages broadcast so far.
+    */
+    //=========================================================================
+    std::size_t pending_message_count() const;
+
+    //=========================================================================
+    /*! \brief The port the server listens on, once run() has succeeded.
+    */
+    //=========================================================================
+    unsigned short port() const;
+
+  private:
+    const boost::asio::ip::tcp::endpoint Endpoint;
+    boost::asio::io_context& Ioc;
+    boost::asio::ip::tcp::acceptor Acceptor;
+    boost::asio::ssl::context* Ctx{nullptr};
+
+    // State shared with the sessions, which may outlive the server
+    std::shared_ptr<WebSocketSubscribers> Subscribers_pt;
+
+    // Accept the next connection
+    void listen_to_incoming_connection();
+    void on_accept(const boost::system::error_code& ec,
+                   boost::asio::ip::tcp::socket socket);
+  };
+} // namespace NetworkMonitor
+
+#endif
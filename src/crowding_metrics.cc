@@ -0,0 +1,278 @@
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The matching header
+#include "network-monitor/crowding_metrics.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // Round towards negative infinity, so that timestamps before the epoch
+  // still land in the right bucket
+  //===========================================================================
+  static std::int64_t floor_divide(std::int64_t a, std::int64_t b)
+  {
+    const std::int64_t quotient{a/b};
+    return ((a%b!=0) && ((a<0)!=(b<0))) ? quotient-1 : quotient;
+  } // End of floor_divide
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct the metrics for a network.
+
+      \param network_layout The parsed network-layout.json file; its
+                            "lines" list defines the per-line rates.
+      \param stations       The dense station IDs. It must outlive the
+                            metrics.
+      \param bucket_width   The time resolution of the windows. It should
+                            divide one minute.
+  */
+  //=========================================================================
+  CrowdingMetrics::CrowdingMetrics(const nlohmann::json& network_layout,
+                                   const StationIndex& stations,
+                                   std::chrono::seconds bucket_width) :
+    Stations(stations),
+    Bucket_width(std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::max(bucket_width,std::chrono::seconds(1))).count())
+  {
+    // Window lengths, rounded up to whole buckets.
+    const std::int64_t minute{60000000};
+    const std::array<std::int64_t,N_windows> window_lengths{
+      minute,5*minute,15*minute};
+    for (std::size_t w=0; w<N_windows; w++)
+    {
+      Window_buckets[w]=static_cast<std::size_t>(
+        (window_lengths[w]+Bucket_width-1)/Bucket_width);
+    }
+    N_buckets=Window_buckets[N_windows-1];
+    N_columns=2*Stations.size();
+    Buckets.assign(N_buckets*N_columns,0);
+    Window_totals.assign(N_windows*N_columns,0);
+
+    // Stations of each line, skipping those the station index does not know.
+    Line_offsets.push_back(0);
+    if (network_layout.contains("lines"))
+    {
+      for (const auto& line : network_layout.at("lines"))
+      {
+        Line_ids.push_back(line.value("line_id",""));
+        if (line.contains("stations"))
+        {
+          for (const auto& station_id : line.at("stations"))
+          {
+            const std::uint32_t station{
+              Stations.find(station_id.get<std::string>())};
+            if (station!=StationIndex::npos)
+            {
+              Line_stations.push_back(station);
+            }
+          }
+        }
+        Line_offsets.push_back(Line_stations.size());
+      }
+    }
+  } // End of CrowdingMetrics
+
+  //=========================================================================
+  /*! \brief Count a passenger event.
+
+      Events newer than the current bucket advance the windows first.
+      Late events are added to the bucket they belong to, as long as it is
+      still within the longest window.
+
+      \returns  false if the event is too old or its station is unknown.
+  */
+  //=========================================================================
+  bool CrowdingMetrics::record(const PassengerEvent& event)
+  {
+    if (event.station>=Stations.size())
+    {
+      return false;
+    }
+
+    advance_to(event.timestamp);
+    const std::int64_t age{
+      Head_bucket-floor_divide(event.timestamp,Bucket_width)};
+    if (age>=static_cast<std::int64_t>(N_buckets))
+    {
+      return false;
+    }
+
+    // Count the event in its bucket and in every window that still covers
+    // that bucket.
+    const std::size_t col{column(event.station,event.direction)};
+    Buckets[row(static_cast<std::size_t>(age))*N_columns+col]++;
+    for (std::size_t w=0; w<N_windows; w++)
+    {
+      if (static_cast<std::size_t>(age)<Window_buckets[w])
+      {
+        Window_totals[w*N_columns+col]++;
+      }
+    }
+    return true;
+  } // End of record
+
+  //=========================================================================
+  /*! \brief Slide the windows forward so that they end at the given time.
+
+      Call this on a regular tick so that rates decay when no events
+      arrive. Times before the current bucket are ignored.
+
+      \param timestamp  Microseconds since the Unix epoch.
+  */
+  //=========================================================================
+  void CrowdingMetrics::advance_to(std::int64_t timestamp)
+  {
+    const std::int64_t bucket{floor_divide(timestamp,Bucket_width)};
+    if (!Started)
+    {
+      Head_bucket=bucket;
+      Started=true;
+      return;
+    }
+    if (bucket<=Head_bucket)
+    {
+      return;
+    }
+
+    // After a long enough gap every window is empty; start over rather than
+    // stepping through buckets one by one.
+    if (bucket-Head_bucket>=static_cast<std::int64_t>(N_buckets))
+    {
+      std::fill(Buckets.begin(),Buckets.end(),0);
+      std::fill(Window_totals.begin(),Window_totals.end(),0);
+      Head_bucket=bucket;
+      return;
+    }
+
+    while (Head_bucket<bucket)
+    {
+      advance_one();
+    }
+  } // End of advance_to
+
+  //=========================================================================
+  /*! \brief The passenger rate at a station, in events per minute.
+  */
+  //=========================================================================
+  double CrowdingMetrics::station_rate(std::uint32_t station,
+                                       CrowdingWindow window,
+                                       PassengerDirection direction) const
+  {
+    if (station>=Stations.size())
+    {
+      return 0.0;
+    }
+    const std::size_t w{static_cast<std::size_t>(window)};
+    const double minutes{static_cast<double>(Window_buckets[w]*Bucket_width)/
+                         60.0e6};
+    return Window_totals[w*N_columns+column(station,direction)]/minutes;
+  } // End of station_rate
+
+  //=========================================================================
+  /*! \brief The passenger rate across all the stations of a line, in events
+             per minute.
+
+      \param line The position of the line in the layout's "lines" list.
+  */
+  //=========================================================================
+  double CrowdingMetrics::line_rate(std::size_t line,
+                                    CrowdingWindow window,
+                                    PassengerDirection direction) const
+  {
+    if (line>=Line_ids.size())
+    {
+      return 0.0;
+    }
+    double rate{0.0};
+    for (std::size_t i=Line_offsets[line]; i<Line_offsets[line+1]; i++)
+    {
+      rate+=station_rate(Line_stations[i],window,direction);
+    }
+    return rate;
+  } // End of line_rate
+
+  //=========================================================================
+  /*! \brief The event counts of every station over a window, indexed by
+             dense station ID.
+  */
+  //=========================================================================
+  const std::uint32_t* CrowdingMetrics::window_counts(
+    CrowdingWindow window,
+    PassengerDirection direction) const
+  {
+    return Window_totals.data()+
+      static_cast<std::size_t>(window)*N_columns+column(0,direction);
+  } // End of window_counts
+
+  //=========================================================================
+  /*! \brief The number of lines in the layout.
+  */
+  //=========================================================================
+  std::size_t CrowdingMetrics::line_count() const
+  {
+    return Line_ids.size();
+  } // End of line_count
+
+  //=========================================================================
+  /*! \brief The line ID of a line, e.g. "line_000".
+  */
+  //=========================================================================
+  const std::string& CrowdingMetrics::line_id(std::size_t line) const
+  {
+    return Line_ids[line];
+  } // End of line_id
+
+  // Private methods
+
+  //=========================================================================
+  //
+  //=========================================================================
+  std::size_t CrowdingMetrics::column(std::uint32_t station,
+                                      PassengerDirection direction) const
+  {
+    return (direction==PassengerDirection::In ? 0 : Stations.size())+station;
+  } // End of column
+
+  //=========================================================================
+  //
+  //=========================================================================
+  std::size_t CrowdingMetrics::row(std::size_t age) const
+  {
+    return (Head_row+N_buckets-age)%N_buckets;
+  } // End of row
+
+  //=========================================================================
+  // Each window loses its oldest row. For the longest window that row is the
+  // one the new head reuses, so it is cleared last.
+  //=========================================================================
+  void CrowdingMetrics::advance_one()
+  {
+    Head_bucket++;
+    Head_row=(Head_row+1)%N_buckets;
+
+    for (std::size_t w=0; w<N_windows; w++)
+    {
+      std::uint32_t* totals{Window_totals.data()+w*N_columns};
+      const std::uint32_t* leaving{
+        Buckets.data()+row(Window_buckets[w])*N_columns};
+      for (std::size_t i=0; i<N_columns; i++)
+      {
+        totals[i]-=leaving[i];
+      }
+    }
+
+    std::uint32_t* head{Buckets.data()+Head_row*N_columns};
+    std::fill(head,head+N_columns,0);
+  } // End of advance_one
+} // namespace NetworkMonitor
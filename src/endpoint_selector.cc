@@ -0,0 +1,468 @@
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/system/error_code.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The matching header
+#include "network-monitor/endpoint_selector.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // The round-trip time of a candidate that failed its probe
+  //===========================================================================
+  static constexpr std::chrono::microseconds Unhealthy{
+    std::chrono::microseconds::max()};
+
+  //===========================================================================
+  // General logging function
+  //===========================================================================
+  static void log(const std::string& where, const std::string& what)
+  {
+    std::cerr << "[" << std::setw(20) << where << "] " << what << std::endl;
+  } // End of log
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct an endpoint selector.
+
+      \note This constructor does not initiate a connection.
+
+      \param candidates The endpoints to choose from.
+      \param ioc        The io_context object. The user takes care of
+                        calling ioc.run().
+      \param ctx        The TLS context to setup TLS socket streams.
+      \param options    Probing and degradation settings.
+  */
+  //=========================================================================
+  EndpointSelector::EndpointSelector(std::vector<WebSocketEndpoint> candidates,
+                                     boost::asio::io_context& ioc,
+                                     boost::asio::ssl::context& ctx,
+                                     EndpointSelectorOptions options) :
+    Candidates(std::move(candidates)),
+    Ioc(ioc),
+    Ctx(ctx),
+    Options(options),
+    Probe_timer(ioc),
+    Monitor_timer(ioc)
+  {} // End of EndpointSelector
+
+  //=========================================================================
+  /*! \brief Destructor
+  */
+  //=========================================================================
+  EndpointSelector::~EndpointSelector() = default;
+
+  //=========================================================================
+  /*! \brief Probe the candidates and connect to the best one.
+
+      \param on_connect     Called when the connection fails or succeeds,
+                            and again after every migration.
+      \param on_message     Called only when a message is successfully
+                            received. The message is an rvalue reference;
+                            ownership is passed to the receiver.
+      \param on_disconnect  Called when the active connection is closed by
+                            the server or due to a connection error.
+  */
+  //=========================================================================
+  void EndpointSelector::connect(
+    std::function<void (boost::system::error_code)> on_connect,
+    std::function<void (boost::system::error_code,
+                        std::string&&)> on_message,
+    std::function<void (boost::system::error_code)> on_disconnect)
+  {
+    // Save the callbacks for later use
+    OnConnectPt=on_connect;
+    OnMessagePt=on_message;
+    OnDisconnectPt=on_disconnect;
+
+    Closing=false;
+    start_probe_round();
+  } // End of connect
+
+  //=========================================================================
+  /*! \brief Send a text message on the active connection.
+
+      \param message  The message to send.
+      \param on_send  Called when a message is sent successfully or if it
+                      failed to send.
+  */
+  //=========================================================================
+  void EndpointSelector::send(
+    const std::string& message,
+    std::function<void (boost::system::error_code)> on_send)
+  {
+    if (!Active)
+    {
+      if (on_send)
+      {
+        on_send(boost::asio::error::not_connected);
+      }
+      return;
+    }
+    Active->Client->send(message,on_send);
+  } // End of send
+
+  //=========================================================================
+  /*! \brief Stop probing and close the active connection.
+
+      \param on_close Called when the connection is closed, successfully or
+                      not.
+  */
+  //=========================================================================
+  void EndpointSelector::close(
+    std::function<void (boost::system::error_code)> on_close)
+  {
+    Closing=true;
+    Probing=false;
+    Probe_timer.cancel();
+    Monitor_timer.cancel();
+    for (auto& probe : Probes)
+    {
+      probe.Client->close();
+      Retired.push_back(std::move(probe));
+    }
+    Probes.clear();
+
+    if (!Active)
+    {
+      if (on_close)
+      {
+        on_close(boost::asio::error::not_connected);
+      }
+      return;
+    }
+    Active->Client->close(on_close);
+  } // End of close
+
+  //=========================================================================
+  /*! \brief The endpoint of the active connection, or nullptr.
+  */
+  //=========================================================================
+  const WebSocketEndpoint* EndpointSelector::active_endpoint() const
+  {
+    return Active ? &Candidates[Active->Candidate] : nullptr;
+  } // End of active_endpoint
+
+  //=========================================================================
+  /*! \brief The client of the active connection, or nullptr. Use it to
+             read the round-trip times of the connection.
+  */
+  //=========================================================================
+  const WebSocketClient* EndpointSelector::active_client() const
+  {
+    return Active ? Active->Client.get() : nullptr;
+  } // End of active_client
+
+  // Private methods
+
+  //=========================================================================
+  // Connect to every candidate but the active one and ping each of them
+  // Options.probe_pings times.
+  //=========================================================================
+  void EndpointSelector::start_probe_round()
+  {
+    // Forget the connections that have wound down since the last round.
+    Retired.erase(std::remove_if(Retired.begin(),Retired.end(),
+                                 [](const Connection& connection)
+    {
+      return *connection.Finished;
+    }),Retired.end());
+
+    Probing=true;
+    Probe_round++;
+    Probe_rtts.assign(Candidates.size(),Unhealthy);
+    Probe_reported.assign(Candidates.size(),false);
+    Probes_pending=0;
+
+    const std::uint64_t round{Probe_round};
+    for (std::size_t i=0; i<Candidates.size(); i++)
+    {
+      // A lost active connection may come back, so probe it too.
+      if (Active && !Active_lost && (Active->Candidate==i))
+      {
+        continue;
+      }
+
+      Connection probe{};
+      probe.Candidate=i;
+      probe.Client=std::make_unique<WebSocketClient>(
+        Candidates[i].url,Candidates[i].endpoint,Candidates[i].port,Ioc,Ctx);
+      WebSocketClient* client{probe.Client.get()};
+      auto finished{probe.Finished};
+
+      auto on_rtt{[this,client,round,i](auto)
+      {
+        if (client->rtt_histogram().count()>=Options.probe_pings)
+        {
+          on_probe_done(round,i,client->rtt_histogram().percentile(0.5));
+          client->close();
+        }
+      }};
+      auto on_connect{[this,client,finished,round,i,on_rtt](auto ec)
+      {
+        if (ec)
+        {
+          *finished=true;
+          on_probe_done(round,i,Unhealthy);
+          return;
+        }
+
+        // The round may have ended while we were connecting.
+        if (!Probing || (round!=Probe_round))
+        {
+          client->close();
+          return;
+        }
+        client->start_ping(Options.probe_interval,on_rtt);
+      }};
+      auto on_disconnect{[finished](auto)
+      {
+        *finished=true;
+      }};
+      client->connect(on_connect,nullptr,on_disconnect);
+
+      Probes.push_back(std::move(probe));
+      Probes_pending++;
+    }
+
+    // Give up on the candidates that are too slow to answer.
+    Probe_timer.expires_after(Options.probe_timeout);
+    Probe_timer.async_wait(
+      [this,round](auto ec)
+    {
+      if (!ec && Probing && (round==Probe_round))
+      {
+        finish_probe_round();
+      }
+    });
+
+    if (Probes_pending==0)
+    {
+      boost::asio::post(
+        Ioc,
+        [this,round]()
+      {
+        if (Probing && (round==Probe_round))
+        {
+          finish_probe_round();
+        }
+      });
+    }
+  } // End of start_probe_round
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void EndpointSelector::on_probe_done(std::uint64_t round,
+                                       std::size_t candidate,
+                                       std::chrono::microseconds rtt)
+  {
+    if (!Probing || (round!=Probe_round) || Probe_reported[candidate])
+    {
+      return;
+    }
+    Probe_reported[candidate]=true;
+    Probe_rtts[candidate]=rtt;
+    if (--Probes_pending==0)
+    {
+      finish_probe_round();
+    }
+  } // End of on_probe_done
+
+  //=========================================================================
+  // Pick the fastest healthy candidate and connect to it if it beats the
+  // active connection (or if there is none).
+  //=========================================================================
+  void EndpointSelector::finish_probe_round()
+  {
+    Probing=false;
+    Probe_timer.cancel();
+
+    // The probes that did not finish in time are closed too.
+    for (auto& probe : Probes)
+    {
+      if (!Probe_reported[probe.Candidate])
+      {
+        probe.Client->close();
+      }
+      Retired.push_back(std::move(probe));
+    }
+    Probes.clear();
+
+    const auto best{static_cast<std::size_t>(
+      std::min_element(Probe_rtts.begin(),Probe_rtts.end())-
+      Probe_rtts.begin())};
+    const bool found{(best<Probe_rtts.size()) && (Probe_rtts[best]!=Unhealthy)};
+
+    if (!Active)
+    {
+      if (!found)
+      {
+        log("finish_probe_round","No healthy endpoint");
+        if (OnConnectPt)
+        {
+          OnConnectPt(boost::asio::error::host_unreachable);
+        }
+        return;
+      }
+      activate(best);
+      return;
+    }
+
+    // Compare with the active connection.
+    const WebSocketClient& active{*Active->Client};
+    const std::chrono::microseconds current{
+      (Active_lost || (active.missed_pongs()>=Options.max_missed_pongs)) ?
+      Unhealthy : active.rtt_histogram().percentile(0.5)};
+    if (found && (Probe_rtts[best]<current))
+    {
+      log("finish_probe_round","Migrating to "+Candidates[best].url);
+      activate(best);
+    }
+    else if (current!=Unhealthy)
+    {
+      // Nothing better: accept the current latency as the new normal, so
+      // that we do not probe again until it degrades further.
+      Baseline_rtt=current;
+    }
+    else if (Active_lost)
+    {
+      // monitor() tries again on its next check.
+      log("finish_probe_round","No healthy endpoint to fail over to");
+    }
+  } // End of finish_probe_round
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void EndpointSelector::activate(std::size_t candidate)
+  {
+    Pending=std::make_unique<Connection>();
+    Pending->Candidate=candidate;
+    Pending->Client=std::make_unique<WebSocketClient>(
+      Candidates[candidate].url,Candidates[candidate].endpoint,
+      Candidates[candidate].port,Ioc,Ctx);
+    Baseline_rtt=Probe_rtts[candidate];
+
+    WebSocketClient* client{Pending->Client.get()};
+    auto finished{Pending->Finished};
+    auto on_connect{[this](auto ec)
+    {
+      on_activated(ec);
+    }};
+    auto on_message{[this](auto ec, auto&& message)
+    {
+      if (OnMessagePt)
+      {
+        OnMessagePt(ec,std::move(message));
+      }
+    }};
+    auto on_disconnect{[this,client,finished](auto ec)
+    {
+      *finished=true;
+
+      // Only the loss of the connection the user is relying on matters.
+      if (!Active || (Active->Client.get()!=client) || Closing)
+      {
+        return;
+      }
+
+      // A lost connection is as degraded as it gets: fail over at once
+      // rather than wait for monitor(), whose pings stop with it.
+      Active_lost=true;
+      if (OnDisconnectPt)
+      {
+        OnDisconnectPt(ec);
+      }
+      if (!Probing && !Pending && (Candidates.size()>1))
+      {
+        log("activate","Lost "+Candidates[Active->Candidate].url+
+                       ", failing over");
+        start_probe_round();
+      }
+    }};
+    client->connect(on_connect,on_message,on_disconnect);
+  } // End of activate
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void EndpointSelector::on_activated(const boost::system::error_code& ec)
+  {
+    if (ec)
+    {
+      *Pending->Finished=true;
+      Retired.push_back(std::move(*Pending));
+      Pending.reset();
+
+      // A failed migration keeps the current connection.
+      if (!Active && OnConnectPt)
+      {
+        OnConnectPt(ec);
+      }
+      return;
+    }
+
+    // Make before break: only now close the old connection.
+    if (Active)
+    {
+      Active->Client->close();
+      Retired.push_back(std::move(*Active));
+    }
+    Active=std::move(Pending);
+    Active_lost=false;
+    Active->Client->start_ping(Options.ping_interval);
+    Monitor_timer.cancel();
+    monitor({});
+
+    // Note: This call is synchronous and will block the io_context.
+    if (OnConnectPt)
+    {
+      OnConnectPt(ec);
+    }
+  } // End of on_activated
+
+  //=========================================================================
+  // Check the active connection once per ping interval.
+  //=========================================================================
+  void EndpointSelector::monitor(const boost::system::error_code& ec)
+  {
+    if ((ec==boost::asio::error::operation_aborted) || Closing || !Active)
+    {
+      return;
+    }
+
+    const WebSocketClient& active{*Active->Client};
+    const auto& rtt{active.rtt_histogram()};
+    const std::chrono::microseconds threshold{static_cast<std::int64_t>(
+      static_cast<double>(Baseline_rtt.count())*Options.degradation_factor)};
+    const bool degraded{
+      Active_lost || (active.missed_pongs()>=Options.max_missed_pongs) ||
+      ((rtt.count()>=Options.min_samples) &&
+       (rtt.percentile(0.5)>threshold))};
+    if (degraded && !Probing && !Pending && (Candidates.size()>1))
+    {
+      start_probe_round();
+    }
+
+    Monitor_timer.expires_after(Options.ping_interval);
+    Monitor_timer.async_wait(
+      [this](auto ec)
+    {
+      monitor(ec);
+    });
+  } // End of monitor
+} // namespace NetworkMonitor
@@ -0,0 +1,796 @@
+// POSIX file and memory-mapping functions
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Regular libraries
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// The matching header
+#include "network-monitor/event_log.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  /*! \brief Header of a segment file; the blocks follow it.
+  */
+  //===========================================================================
+  struct EventLogSegmentHeader
+  {
+    char Magic[8];
+    std::uint64_t Reserved;
+  };
+
+  //===========================================================================
+  /*! \brief Header of a block; the timestamp, station and direction columns
+             follow it, and the block is padded to a multiple of 8 bytes.
+  */
+  //===========================================================================
+  struct EventLogBlockHeader
+  {
+    char Magic[4];
+    std::uint32_t N_events;
+    std::int64_t Min_time;
+    std::int64_t Max_time;
+    std::int64_t First_time;
+
+    // Size of the whole block, this header included
+    std::uint32_t Size;
+
+    // Size of the timestamp column, and width of a station ID, in bytes
+    std::uint32_t Timestamps_size;
+    std::uint32_t Station_width;
+    std::uint32_t Reserved;
+  };
+
+  static constexpr char Segment_magic[8]{'N','M','E','V','L','G','0','1'};
+  static constexpr char Block_magic[4]{'N','M','E','B'};
+
+  // Keep the size of a block within its 32-bit Size field.
+  static constexpr std::size_t Max_block_events{1<<24};
+
+  //===========================================================================
+  // Name of a segment file, e.g. segment-000042.evlog
+  //===========================================================================
+  static std::filesystem::path segment_path(
+    const std::filesystem::path& directory,
+    std::size_t number)
+  {
+    char name[32]{};
+    std::snprintf(name,sizeof(name),"segment-%06zu.evlog",number);
+    return directory/name;
+  } // End of segment_path
+
+  //===========================================================================
+  // Whether a file is a segment of a log
+  //===========================================================================
+  static bool is_segment(const std::filesystem::path& file)
+  {
+    const std::string name{file.stem().string()};
+    return (file.extension()==".evlog") &&
+           (name.size()>8) && (name.size()<=20) &&
+           (name.compare(0,8,"segment-")==0) &&
+           std::all_of(name.begin()+8,name.end(),[](char c)
+    {
+      return (c>='0') && (c<='9');
+    });
+  } // End of is_segment
+
+  //===========================================================================
+  // Append the whole of a buffer to a file, resuming after short writes
+  //===========================================================================
+  static bool write_all(int fd, const char* data, std::size_t size)
+  {
+    while (size>0)
+    {
+      const ssize_t n_written{write(fd,data,size)};
+      if (n_written<0)
+      {
+        if (errno==EINTR)
+        {
+          continue;
+        }
+        return false;
+      }
+      data+=n_written;
+      size-=static_cast<std::size_t>(n_written);
+    }
+    return true;
+  } // End of write_all
+
+  //===========================================================================
+  // Append a difference between timestamps, zigzag and LEB128-encoded
+  //===========================================================================
+  static void append_delta(std::uint64_t delta, std::string& block)
+  {
+    // Zigzag: small negative and positive differences both get small codes.
+    std::uint64_t code{(delta<<1)^(0-(delta>>63))};
+    while (code>=0x80)
+    {
+      block.push_back(static_cast<char>((code&0x7F)|0x80));
+      code>>=7;
+    }
+    block.push_back(static_cast<char>(code));
+  } // End of append_delta
+
+  //===========================================================================
+  // Decode a difference written by append_delta; false if it overruns end
+  //===========================================================================
+  static bool read_delta(const unsigned char*& data,
+                         const unsigned char* end,
+                         std::uint64_t& delta)
+  {
+    // The usual gaps take one or two bytes, in no predictable order; decode
+    // both cases without branching on the length.
+    std::uint64_t code{0};
+    if ((end-data>=2) && (((data[0]&data[1])&0x80)==0))
+    {
+      const std::uint64_t n_extra{static_cast<std::uint64_t>(data[0]>>7)};
+      code=(data[0]&0x7Fu)|((static_cast<std::uint64_t>(data[1])<<7)*n_extra);
+      data+=1+n_extra;
+      delta=(code>>1)^(0-(code&1));
+      return true;
+    }
+    for (unsigned shift{0}; (data<end) && (shift<64); shift+=7)
+    {
+      const std::uint64_t byte{*data++};
+      code|=(byte&0x7F)<<shift;
+      if (byte<0x80)
+      {
+        delta=(code>>1)^(0-(code&1));
+        return true;
+      }
+    }
+    return false;
+  } // End of read_delta
+
+  //===========================================================================
+  // Append the low width bytes of each station ID
+  //===========================================================================
+  template <typename Narrow>
+  static void append_stations(const std::vector<std::uint32_t>& stations,
+                              std::string& block)
+  {
+    const std::size_t offset{block.size()};
+    block.resize(offset+stations.size()*sizeof(Narrow));
+    char* data{block.data()+offset};
+    for (const std::uint32_t station : stations)
+    {
+      const Narrow narrow{static_cast<Narrow>(station)};
+      std::memcpy(data,&narrow,sizeof(narrow));
+      data+=sizeof(narrow);
+    }
+  } // End of append_stations
+
+  //===========================================================================
+  // Widen a station column back to 32-bit IDs
+  //===========================================================================
+  template <typename Narrow>
+  static void read_stations(const unsigned char* data,
+                            std::size_t n_events,
+                            std::uint32_t* stations)
+  {
+    for (std::size_t i=0; i<n_events; i++)
+    {
+      Narrow narrow{};
+      std::memcpy(&narrow,data+i*sizeof(narrow),sizeof(narrow));
+      stations[i]=narrow;
+    }
+  } // End of read_stations
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct a writer.
+
+      \param directory  The directory of the log. It is created on the first
+                        write if needed. Blocks already in it are kept; new
+                        events go to a new segment.
+      \param options    Block and segment sizes.
+  */
+  //=========================================================================
+  EventLogWriter::EventLogWriter(std::filesystem::path directory,
+                                 EventLogOptions options) :
+    Directory(std::move(directory)),
+    Options{std::clamp<std::size_t>(options.block_events,1,Max_block_events),
+            std::max<std::size_t>(options.segment_blocks,1)}
+  {
+    // Start after the last segment already in the directory.
+    std::error_code ec{};
+    for (std::filesystem::directory_iterator entry{Directory,ec}, end{};
+         !ec && (entry!=end); entry.increment(ec))
+    {
+      if (is_segment(entry->path()))
+      {
+        const std::string name{entry->path().stem().string()};
+        Segment_number=std::max<std::size_t>(
+          Segment_number,std::stoull(name.substr(8),nullptr,10)+1);
+      }
+    }
+
+    Timestamps.reserve(Options.block_events);
+    Stations.reserve(Options.block_events);
+    Directions.reserve(Options.block_events);
+  } // End of EventLogWriter
+
+  //=========================================================================
+  /*! \brief Destructor; writes the events still buffered.
+  */
+  //=========================================================================
+  EventLogWriter::~EventLogWriter()
+  {
+    flush();
+    close_segment();
+  } // End of ~EventLogWriter
+
+  //=========================================================================
+  /*! \brief Append an event.
+
+      \returns  false if the event completed a block that could not be
+                written. The block is dropped.
+  */
+  //=========================================================================
+  bool EventLogWriter::append(const PassengerEvent& event)
+  {
+    Timestamps.push_back(event.timestamp);
+    Stations.push_back(event.station);
+    Directions.push_back(event.direction);
+    N_events++;
+    return (Timestamps.size()<Options.block_events) || flush();
+  } // End of append
+
+  //=========================================================================
+  /*! \brief Decode and append the passenger events of a WebSocket message.
+
+      The message holds one or more STOMP frames, each ending with its NULL
+      octet. Frames that are not valid passenger events are skipped.
+
+      \param message    The message, as passed to the on_message handler of
+                        WebSocketClient.
+      \param parser     The parser of the frames.
+      \param n_dropped  If not null, set to the number of events lost
+                        because a block could not be written. Such a block
+                        may hold events of earlier calls too.
+      \returns          The number of events of the message for which
+                        append() succeeded.
+  */
+  //=========================================================================
+  std::size_t EventLogWriter::append_message(std::string_view message,
+                                             const PassengerEventParser& parser,
+                                             std::size_t* n_dropped)
+  {
+    const std::size_t n_dropped_before{N_dropped};
+    std::size_t n_appended{0};
+    PassengerEvent event{};
+    while (!message.empty())
+    {
+      const std::size_t frame_end{message.find('\0')};
+      const std::string_view frame{message.substr(0,frame_end)};
+      if (parser.parse_stomp_frame(frame,event) && append(event))
+      {
+        n_appended++;
+      }
+      if (frame_end==std::string_view::npos)
+      {
+        break;
+      }
+      message.remove_prefix(frame_end+1);
+    }
+    if (n_dropped!=nullptr)
+    {
+      *n_dropped=N_dropped-n_dropped_before;
+    }
+    return n_appended;
+  } // End of append_message
+
+  //=========================================================================
+  /*! \brief Write the buffered events as a (possibly short) block.
+
+      \returns  false if the block could not be written.
+  */
+  //=========================================================================
+  bool EventLogWriter::flush()
+  {
+    const std::size_t n_events{Timestamps.size()};
+    if (n_events==0)
+    {
+      return true;
+    }
+
+    EventLogBlockHeader header{};
+    std::memcpy(header.Magic,Block_magic,sizeof(header.Magic));
+    header.N_events=static_cast<std::uint32_t>(n_events);
+    header.First_time=Timestamps.front();
+    const auto [min_time,max_time]{
+      std::minmax_element(Timestamps.begin(),Timestamps.end())};
+    header.Min_time=*min_time;
+    header.Max_time=*max_time;
+
+    // Timestamps, as differences from the previous event
+    Block.assign(sizeof(header),'\0');
+    for (std::size_t i=1; i<n_events; i++)
+    {
+      append_delta(static_cast<std::uint64_t>(Timestamps[i])-
+                   static_cast<std::uint64_t>(Timestamps[i-1]),Block);
+    }
+    header.Timestamps_size=static_cast<std::uint32_t>(
+      Block.size()-sizeof(header));
+
+    // Station IDs, as narrow as the largest one allows
+    const std::uint32_t max_station{
+      *std::max_element(Stations.begin(),Stations.end())};
+    if (max_station<=0xFF)
+    {
+      header.Station_width=1;
+      append_stations<std::uint8_t>(Stations,Block);
+    }
+    else if (max_station<=0xFFFF)
+    {
+      header.Station_width=2;
+      append_stations<std::uint16_t>(Stations,Block);
+    }
+    else
+    {
+      header.Station_width=4;
+      append_stations<std::uint32_t>(Stations,Block);
+    }
+
+    // Directions, one bit per event
+    const std::size_t directions_offset{Block.size()};
+    Block.resize(directions_offset+(n_events+7)/8,'\0');
+    for (std::size_t i=0; i<n_events; i++)
+    {
+      if (Directions[i]==PassengerDirection::Out)
+      {
+        Block[directions_offset+i/8]|=static_cast<char>(1<<(i%8));
+      }
+    }
+
+    Block.resize((Block.size()+7)/8*8,'\0');
+    header.Size=static_cast<std::uint32_t>(Block.size());
+    std::memcpy(Block.data(),&header,sizeof(header));
+
+    Timestamps.clear();
+    Stations.clear();
+    Directions.clear();
+
+    if (!open_segment() || !write_all(Fd,Block.data(),Block.size()))
+    {
+      // The segment may end with part of the block; readers stop there, so
+      // carry on in a new segment.
+      close_segment();
+      N_dropped+=n_events;
+      return false;
+    }
+    if (++Segment_blocks==Options.segment_blocks)
+    {
+      close_segment();
+    }
+    return true;
+  } // End of flush
+
+  //=========================================================================
+  /*! \brief The number of events appended so far, written or buffered.
+             Dropped events are not counted.
+  */
+  //=========================================================================
+  std::size_t EventLogWriter::size() const
+  {
+    return N_events-N_dropped;
+  } // End of size
+
+  //=========================================================================
+  /*! \brief The number of events lost so far because their block could not
+             be written.
+  */
+  //=========================================================================
+  std::size_t EventLogWriter::dropped_event_count() const
+  {
+    return N_dropped;
+  } // End of dropped_event_count
+
+  // Private methods
+
+  //=========================================================================
+  //
+  //=========================================================================
+  bool EventLogWriter::open_segment()
+  {
+    if (Fd>=0)
+    {
+      return true;
+    }
+
+    std::error_code ec{};
+    std::filesystem::create_directories(Directory,ec);
+
+    // Another writer may have taken the next segment since we looked; move
+    // on to the following one rather than fail on every block.
+    do
+    {
+      const std::filesystem::path path{
+        segment_path(Directory,Segment_number)};
+      Fd=open(path.c_str(),O_WRONLY|O_CREAT|O_EXCL|O_CLOEXEC,0644);
+      if ((Fd<0) && (errno==EEXIST))
+      {
+        Segment_number++;
+      }
+    } while ((Fd<0) && (errno==EEXIST));
+    if (Fd<0)
+    {
+      return false;
+    }
+    Segment_number++;
+    Segment_blocks=0;
+
+    EventLogSegmentHeader header{};
+    std::memcpy(header.Magic,Segment_magic,sizeof(header.Magic));
+    if (!write_all(Fd,reinterpret_cast<const char*>(&header),sizeof(header)))
+    {
+      close_segment();
+      return false;
+    }
+    return true;
+  } // End of open_segment
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void EventLogWriter::close_segment()
+  {
+    if (Fd>=0)
+    {
+      close(Fd);
+      Fd=-1;
+    }
+  } // End of close_segment
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Map the segments of a log.
+
+      \param directory  The directory of the log. Segments that cannot be
+                        mapped or do not start with a valid header are
+                        ignored.
+  */
+  //=========================================================================
+  EventLogReader::EventLogReader(const std::filesystem::path& directory)
+  {
+    std::vector<std::filesystem::path> paths{};
+    std::error_code ec{};
+    for (std::filesystem::directory_iterator entry{directory,ec}, end{};
+         !ec && (entry!=end); entry.increment(ec))
+    {
+      if (is_segment(entry->path()))
+      {
+        paths.push_back(entry->path());
+      }
+    }
+    std::sort(paths.begin(),paths.end());
+
+    for (const auto& path : paths)
+    {
+      const int fd{open(path.c_str(),O_RDONLY|O_CLOEXEC)};
+      if (fd<0)
+      {
+        continue;
+      }
+      struct stat file_status{};
+      if ((fstat(fd,&file_status)!=0) ||
+          (static_cast<std::size_t>(file_status.st_size)<
+           sizeof(EventLogSegmentHeader)+sizeof(EventLogBlockHeader)))
+      {
+        close(fd);
+        continue;
+      }
+      const std::size_t file_size{
+        static_cast<std::size_t>(file_status.st_size)};
+      void* mapping{mmap(nullptr,file_size,PROT_READ,MAP_PRIVATE,fd,0)};
+
+      // The mapping stays valid after the descriptor is closed.
+      close(fd);
+      if (mapping==MAP_FAILED)
+      {
+        continue;
+      }
+      Segment segment{};
+      segment.Mapping=mapping;
+      segment.Mapping_size=file_size;
+
+      // Index the blocks, up to the first incomplete or malformed one.
+      const char* data{static_cast<const char*>(mapping)};
+      std::size_t offset{sizeof(EventLogSegmentHeader)};
+      if (std::memcmp(data,Segment_magic,sizeof(Segment_magic))!=0)
+      {
+        offset=file_size;
+      }
+      while (offset+sizeof(EventLogBlockHeader)<=file_size)
+      {
+        EventLogBlockHeader header{};
+        std::memcpy(&header,data+offset,sizeof(header));
+        const std::size_t n_events{header.N_events};
+        if ((std::memcmp(header.Magic,Block_magic,sizeof(Block_magic))!=0) ||
+            (n_events==0) ||
+            (header.Min_time>header.Max_time) ||
+            ((header.Station_width!=1) && (header.Station_width!=2) &&
+             (header.Station_width!=4)) ||
+            (header.Size>file_size-offset) ||
+            (sizeof(header)+header.Timestamps_size+
+             n_events*header.Station_width+(n_events+7)/8>header.Size))
+        {
+          break;
+        }
+        if (segment.Blocks.empty())
+        {
+          segment.Min_time=header.Min_time;
+          segment.Max_time=header.Max_time;
+        }
+        segment.Min_time=std::min(segment.Min_time,header.Min_time);
+        segment.Max_time=std::max(segment.Max_time,header.Max_time);
+        segment.Blocks.push_back({offset,header.Min_time,header.Max_time});
+        N_events+=n_events;
+        offset+=header.Size;
+      }
+
+      if (segment.Blocks.empty())
+      {
+        munmap(mapping,file_size);
+        continue;
+      }
+      Segments.push_back(std::move(segment));
+    }
+  } // End of EventLogReader
+
+  //=========================================================================
+  /*! \brief Move constructor
+  */
+  //=========================================================================
+  EventLogReader::EventLogReader(EventLogReader&& other) noexcept
+  {
+    *this=std::move(other);
+  } // End of EventLogReader
+
+  //=========================================================================
+  /*! \brief Move assignment
+  */
+  //=========================================================================
+  EventLogReader& EventLogReader::operator=(EventLogReader&& other) noexcept
+  {
+    if (this!=&other)
+    {
+      unmap();
+      Segments=std::move(other.Segments);
+      N_events=std::exchange(other.N_events,0);
+      other.Segments.clear();
+    }
+    return *this;
+  } // End of operator=
+
+  //=========================================================================
+  /*! \brief Destructor; unmaps the segments.
+  */
+  //=========================================================================
+  EventLogReader::~EventLogReader()
+  {
+    unmap();
+  } // End of ~EventLogReader
+
+  //=========================================================================
+  /*! \brief Visit the events in [from, to), one block at a time.
+
+      Events come in the order they were written. The arrays of a batch are
+      only valid during the call to on_batch. Blocks with no event in the
+      range are skipped.
+
+      \param from     The first timestamp of the range, in microseconds
+                      since the Unix epoch.
+      \param to       The timestamp past the end of the range.
+      \param on_batch Called with the events of each block in the range.
+      \returns        The number of events visited.
+  */
+  //=========================================================================
+  std::size_t EventLogReader::scan(
+    std::int64_t from,
+    std::int64_t to,
+    const std::function<void (const EventLogBatch&)>& on_batch) const
+  {
+    std::vector<std::int64_t> timestamps{};
+    std::vector<std::uint32_t> stations{};
+    std::vector<PassengerDirection> directions{};
+    std::size_t n_visited{0};
+
+    for (const auto& segment : Segments)
+    {
+      if ((segment.Max_time<from) || (segment.Min_time>=to))
+      {
+        continue;
+      }
+      const unsigned char* data{
+        static_cast<const unsigned char*>(segment.Mapping)};
+      for (const auto& block : segment.Blocks)
+      {
+        if ((block.Max_time<from) || (block.Min_time>=to))
+        {
+          continue;
+        }
+
+        EventLogBlockHeader header{};
+        std::memcpy(&header,data+block.Offset,sizeof(header));
+        const std::size_t n_events{header.N_events};
+        if (timestamps.size()<n_events)
+        {
+          timestamps.resize(n_events);
+          stations.resize(n_events);
+          directions.resize(n_events);
+        }
+
+        // Timestamps
+        const unsigned char* column{data+block.Offset+sizeof(header)};
+        const unsigned char* column_end{column+header.Timestamps_size};
+        std::uint64_t timestamp{static_cast<std::uint64_t>(header.First_time)};
+        timestamps[0]=header.First_time;
+        bool valid{true};
+        for (std::size_t i=1; i<n_events; i++)
+        {
+          std::uint64_t delta{0};
+          valid=read_delta(column,column_end,delta);
+          if (!valid)
+          {
+            break;
+          }
+          timestamp+=delta;
+          timestamps[i]=static_cast<std::int64_t>(timestamp);
+        }
+        if (!valid)
+        {
+          continue;
+        }
+
+        // Station IDs
+        column=column_end;
+        switch (header.Station_width)
+        {
+        case 1:
+          read_stations<std::uint8_t>(column,n_events,stations.data());
+          break;
+        case 2:
+          read_stations<std::uint16_t>(column,n_events,stations.data());
+          break;
+        default:
+          read_stations<std::uint32_t>(column,n_events,stations.data());
+          break;
+        }
+
+        // Directions
+        column+=n_events*header.Station_width;
+        for (std::size_t i=0; i<n_events; i++)
+        {
+          directions[i]=static_cast<PassengerDirection>(
+            (column[i/8]>>(i%8))&1);
+        }
+
+        // Keep the events in the range, unless the whole block is in it.
+        std::size_t n_kept{n_events};
+        if ((block.Min_time<from) || (block.Max_time>=to))
+        {
+          n_kept=0;
+          for (std::size_t i=0; i<n_events; i++)
+          {
+            if ((timestamps[i]>=from) && (timestamps[i]<to))
+            {
+              timestamps[n_kept]=timestamps[i];
+              stations[n_kept]=stations[i];
+              directions[n_kept]=directions[i];
+              n_kept++;
+            }
+          }
+        }
+        if (n_kept==0)
+        {
+          continue;
+        }
+
+        on_batch({n_kept,timestamps.data(),stations.data(),directions.data()});
+        n_visited+=n_kept;
+      }
+    }
+    return n_visited;
+  } // End of scan
+
+  //=========================================================================
+  /*! \brief The number of events in the log.
+  */
+  //=========================================================================
+  std::size_t EventLogReader::size() const
+  {
+    return N_events;
+  } // End of size
+
+  //=========================================================================
+  /*! \brief The number of segments mapped.
+  */
+  //=========================================================================
+  std::size_t EventLogReader::segment_count() const
+  {
+    return Segments.size();
+  } // End of segment_count
+
+  //=========================================================================
+  /*! \brief The number of blocks in all the segments.
+  */
+  //=========================================================================
+  std::size_t EventLogReader::block_count() const
+  {
+    std::size_t n_blocks{0};
+    for (const auto& segment : Segments)
+    {
+      n_blocks+=segment.Blocks.size();
+    }
+    return n_blocks;
+  } // End of block_count
+
+  //=========================================================================
+  /*! \brief The earliest timestamp in the log, 0 if it is empty.
+  */
+  //=========================================================================
+  std::int64_t EventLogReader::min_time() const
+  {
+    if (Segments.empty())
+    {
+      return 0;
+    }
+    std::int64_t min_time{Segments.front().Min_time};
+    for (const auto& segment : Segments)
+    {
+      min_time=std::min(min_time,segment.Min_time);
+    }
+    return min_time;
+  } // End of min_time
+
+  //=========================================================================
+  /*! \brief The latest timestamp in the log, 0 if it is empty.
+  */
+  //=========================================================================
+  std::int64_t EventLogReader::max_time() const
+  {
+    if (Segments.empty())
+    {
+      return 0;
+    }
+    std::int64_t max_time{Segments.front().Max_time};
+    for (const auto& segment : Segments)
+    {
+      max_time=std::max(max_time,segment.Max_time);
+    }
+    return max_time;
+  } // End of max_time
+
+  // Private methods
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void EventLogReader::unmap()
+  {
+    for (const auto& segment : Segments)
+    {
+      munmap(segment.Mapping,segment.Mapping_size);
+    }
+    Segments.clear();
+  } // End of unmap
+} // namespace NetworkMonitor
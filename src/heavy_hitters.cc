@@ -0,0 +1,272 @@
+// Regular libraries
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// The matching header
+#include "network-monitor/heavy_hitters.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // 64-bit finaliser from MurmurHash3, with a per-row seed
+  //===========================================================================
+  static std::uint64_t row_hash(std::uint64_t key, std::size_t row)
+  {
+    key^=0x9E3779B97F4A7C15ULL*(row+1);
+    key^=key>>33;
+    key*=0xFF51AFD7ED558CCDULL;
+    key^=key>>33;
+    key*=0xC4CEB9FE1A85EC53ULL;
+    key^=key>>33;
+    return key;
+  } // End of row_hash
+
+  //===========================================================================
+  // Smallest power of two not below n (and at least 1)
+  //===========================================================================
+  static std::size_t ceil_power_of_two(std::size_t n)
+  {
+    std::size_t power{1};
+    while (power<n)
+    {
+      power<<=1;
+    }
+    return power;
+  } // End of ceil_power_of_two
+
+  //===========================================================================
+  //
+  //===========================================================================
+  static bool higher(const HeavyHitters::Entry& a, const HeavyHitters::Entry& b)
+  {
+    return (a.count>b.count) || ((a.count==b.count) && (a.key<b.key));
+  } // End of higher
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct an empty sketch.
+
+      \param width  The number of counters per row, rounded up to a power
+                    of two.
+      \param depth  The number of rows.
+  */
+  //=========================================================================
+  CountMinSketch::CountMinSketch(std::size_t width, std::size_t depth) :
+    Width_mask(ceil_power_of_two(width)-1),
+    Depth(std::max<std::size_t>(depth,1)),
+    Counters((Width_mask+1)*Depth,0)
+  {} // End of CountMinSketch
+
+  //=========================================================================
+  /*! \brief Count a key, and return its new estimate.
+  */
+  //=========================================================================
+  std::uint64_t CountMinSketch::add(std::uint64_t key, std::uint64_t count)
+  {
+    Total+=count;
+    std::uint64_t estimate{std::numeric_limits<std::uint64_t>::max()};
+    for (std::size_t row=0; row<Depth; row++)
+    {
+      std::uint64_t& counter{Counters[column(row,key)]};
+      counter+=count;
+      estimate=std::min(estimate,counter);
+    }
+    return estimate;
+  } // End of add
+
+  //=========================================================================
+  /*! \brief The estimated count of a key.
+  */
+  //=========================================================================
+  std::uint64_t CountMinSketch::estimate(std::uint64_t key) const
+  {
+    std::uint64_t estimate{std::numeric_limits<std::uint64_t>::max()};
+    for (std::size_t row=0; row<Depth; row++)
+    {
+      estimate=std::min(estimate,Counters[column(row,key)]);
+    }
+    return estimate;
+  } // End of estimate
+
+  //=========================================================================
+  /*! \brief The sum of all the counts added so far.
+  */
+  //=========================================================================
+  std::uint64_t CountMinSketch::total() const
+  {
+    return Total;
+  } // End of total
+
+  //=========================================================================
+  /*! \brief Reset every counter to zero.
+  */
+  //=========================================================================
+  void CountMinSketch::clear()
+  {
+    std::fill(Counters.begin(),Counters.end(),0);
+    Total=0;
+  } // End of clear
+
+  //=========================================================================
+  /*! \brief Construct an empty heavy hitters tracker.
+
+      \param k      The number of keys to keep track of.
+      \param width  The width of the sketch.
+      \param depth  The depth of the sketch.
+  */
+  //=========================================================================
+  HeavyHitters::HeavyHitters(std::size_t k,
+                             std::size_t width,
+                             std::size_t depth) :
+    K(k),
+    Sketch(width,depth)
+  {
+    Heap.reserve(K);
+    Positions.reserve(2*K);
+  } // End of HeavyHitters
+
+  //=========================================================================
+  /*! \brief Count a key.
+  */
+  //=========================================================================
+  void HeavyHitters::add(std::uint64_t key, std::uint64_t count)
+  {
+    const std::uint64_t estimate{Sketch.add(key,count)};
+    if (K==0)
+    {
+      return;
+    }
+
+    // Already a candidate: estimates only grow, so it can only sink
+    // further from the root of the min-heap.
+    const auto found{Positions.find(key)};
+    if (found!=Positions.end())
+    {
+      Heap[found->second].count=estimate;
+      sift_down(found->second);
+      return;
+    }
+
+    if (Heap.size()<K)
+    {
+      Heap.push_back({key,estimate});
+      sift_up(Heap.size()-1);
+      return;
+    }
+
+    // Replace the weakest candidate if the new key overtakes it.
+    const Entry entry{key,estimate};
+    if (higher(entry,Heap[0]))
+    {
+      Positions.erase(Heap[0].key);
+      Heap[0]=entry;
+      sift_down(0);
+    }
+  } // End of add
+
+  //=========================================================================
+  /*! \brief The K keys with the highest estimates, in no particular order.
+
+      \note The reference is invalidated by the next update.
+  */
+  //=========================================================================
+  const std::vector<HeavyHitters::Entry>& HeavyHitters::top() const
+  {
+    return Heap;
+  } // End of top
+
+  //=========================================================================
+  /*! \brief The K keys with the highest estimates, highest first.
+  */
+  //=========================================================================
+  std::vector<HeavyHitters::Entry> HeavyHitters::sorted_top() const
+  {
+    std::vector<Entry> sorted{Heap};
+    std::sort(sorted.begin(),sorted.end(),higher);
+    return sorted;
+  } // End of sorted_top
+
+  //=========================================================================
+  /*! \brief The underlying sketch, to estimate any key.
+  */
+  //=========================================================================
+  const CountMinSketch& HeavyHitters::sketch() const
+  {
+    return Sketch;
+  } // End of sketch
+
+  //=========================================================================
+  /*! \brief Forget every count, e.g. at the start of a new time window.
+  */
+  //=========================================================================
+  void HeavyHitters::clear()
+  {
+    Sketch.clear();
+    Heap.clear();
+    Positions.clear();
+  } // End of clear
+
+  // Private methods
+
+  //=========================================================================
+  //
+  //=========================================================================
+  std::size_t CountMinSketch::column(std::size_t row, std::uint64_t key) const
+  {
+    return row*(Width_mask+1)+
+      static_cast<std::size_t>(row_hash(key,row)&Width_mask);
+  } // End of column
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void HeavyHitters::sift_down(std::size_t position)
+  {
+    while (true)
+    {
+      std::size_t lowest{position};
+      for (std::size_t child=2*position+1;
+           (child<=2*position+2) && (child<Heap.size()); child++)
+      {
+        if (higher(Heap[lowest],Heap[child]))
+        {
+          lowest=child;
+        }
+      }
+      if (lowest==position)
+      {
+        break;
+      }
+      std::swap(Heap[position],Heap[lowest]);
+      Positions[Heap[position].key]=position;
+      position=lowest;
+    }
+    Positions[Heap[position].key]=position;
+  } // End of sift_down
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void HeavyHitters::sift_up(std::size_t position)
+  {
+    while (position>0)
+    {
+      const std::size_t parent{(position-1)/2};
+      if (!higher(Heap[parent],Heap[position]))
+      {
+        break;
+      }
+      std::swap(Heap[position],Heap[parent]);
+      Positions[Heap[position].key]=position;
+      position=parent;
+    }
+    Positions[Heap[position].key]=position;
+  } // End of sift_up
+} // namespace NetworkMonitor
@@ -0,0 +1,306 @@
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// The matching header
+#include "network-monitor/passenger_event_generator.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // Key of a travel time between two stations, on a given route
+  //===========================================================================
+  static std::string travel_time_key(const std::string& route_id,
+                                     const std::string& start_station_id,
+                                     const std::string& end_station_id)
+  {
+    return route_id+"|"+start_station_id+"|"+end_station_id;
+  } // End of travel_time_key
+
+  //===========================================================================
+  // Heap order of the pending exits: the earliest one at the root
+  //===========================================================================
+  template <typename Exit>
+  static bool later(const Exit& a, const Exit& b)
+  {
+    return a.Time>b.Time;
+  } // End of later
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct a generator.
+
+      \param network_layout The parsed network-layout.json file.
+      \param stations       The dense station IDs of the events. It must
+                            outlive the generator.
+      \param options        Demand settings.
+  */
+  //=========================================================================
+  PassengerEventGenerator::PassengerEventGenerator(
+    const nlohmann::json& network_layout,
+    const StationIndex& stations,
+    PassengerEventGeneratorOptions options) :
+    Options(std::move(options)),
+    Rng(Options.seed),
+    Next_trip(Options.start_time)
+  {
+    // Station weights, 1 unless the station is a hotspot
+    std::vector<double> weights(stations.size(),1.0);
+    for (const auto& hotspot : Options.hotspots)
+    {
+      const std::uint32_t station{stations.find(hotspot.station_id)};
+      if (station!=StationIndex::npos)
+      {
+        weights[station]=std::max(hotspot.weight,0.0);
+      }
+    }
+
+    // Travel times in minutes, by route and pair of consecutive stations
+    std::unordered_map<std::string,double> travel_times{};
+    for (const auto& travel_time : network_layout.value(
+           "travel_times",nlohmann::json::array()))
+    {
+      travel_times[travel_time_key(
+        travel_time.value("route_id",""),
+        travel_time.value("start_station_id",""),
+        travel_time.value("end_station_id",""))]=
+        travel_time.value("travel_time",0.0);
+    }
+
+    Route_weight_sums.push_back(0.0);
+    for (const auto& line : network_layout.value(
+           "lines",nlohmann::json::array()))
+    {
+      for (const auto& route_json : line.value(
+             "routes",nlohmann::json::array()))
+      {
+        const std::string route_id{route_json.value("route_id","")};
+        const auto stops{route_json.value("route_stops",
+                                          std::vector<std::string>{})};
+        Route route{};
+        route.Weight_sums.push_back(0.0);
+        bool usable{stops.size()>=2};
+        for (std::size_t i=0; i<stops.size(); i++)
+        {
+          const std::uint32_t station{stations.find(stops[i])};
+          if (station==StationIndex::npos)
+          {
+            usable=false;
+            break;
+          }
+          std::int64_t arrival{0};
+          if (i>0)
+          {
+            const auto found{travel_times.find(
+              travel_time_key(route_id,stops[i-1],stops[i]))};
+            if (found==travel_times.end())
+            {
+              usable=false;
+              break;
+            }
+            arrival=route.Arrivals.back()+
+              static_cast<std::int64_t>(found->second*60.0e6);
+          }
+          route.Stops.push_back(station);
+          route.Arrivals.push_back(arrival);
+          route.Weight_sums.push_back(route.Weight_sums.back()+
+                                      weights[station]);
+        }
+        if (!usable || (route.Weight_sums.back()<=0.0))
+        {
+          continue;
+        }
+        Route_weight_sums.push_back(Route_weight_sums.back()+
+                                    route.Weight_sums.back());
+        Routes.push_back(std::move(route));
+      }
+    }
+  } // End of PassengerEventGenerator
+
+  //=========================================================================
+  /*! \brief Produce the next event.
+
+      \returns  false if the layout has no usable route.
+  */
+  //=========================================================================
+  bool PassengerEventGenerator::next(PassengerEvent& event)
+  {
+    if (Routes.empty())
+    {
+      return false;
+    }
+
+    // Passengers who arrive before the next trip starts leave first.
+    if (!Exits.empty() && (Exits.front().Time<=Next_trip))
+    {
+      std::pop_heap(Exits.begin(),Exits.end(),later<PendingExit>);
+      event.timestamp=Exits.back().Time;
+      event.station=Exits.back().Station;
+      event.direction=PassengerDirection::Out;
+      Exits.pop_back();
+      return true;
+    }
+    start_trip(event);
+    return true;
+  } // End of next
+
+  //=========================================================================
+  /*! \brief The demand multiplier at a time of day, 1 outside rush hours.
+
+      \param timestamp  Microseconds since the Unix epoch.
+  */
+  //=========================================================================
+  double PassengerEventGenerator::demand(std::int64_t timestamp) const
+  {
+    const double hour{std::fmod(static_cast<double>(timestamp)/3.6e9,24.0)};
+    double multiplier{1.0};
+    for (const auto& rush_hour : Options.rush_hours)
+    {
+      // Distance to the peak, the short way around the clock
+      double distance{std::fabs(hour-rush_hour.peak_hour)};
+      distance=std::min(distance,24.0-distance);
+      const double width{std::max(rush_hour.width_hours,1.0e-3)};
+      multiplier+=rush_hour.extra_demand*
+        std::exp(-distance*distance/(2.0*width*width));
+    }
+    return multiplier;
+  } // End of demand
+
+  //=========================================================================
+  /*! \brief The number of routes trips are drawn from.
+  */
+  //=========================================================================
+  std::size_t PassengerEventGenerator::route_count() const
+  {
+    return Routes.size();
+  } // End of route_count
+
+  // Private methods
+
+  //=========================================================================
+  //
+  //=========================================================================
+  std::size_t PassengerEventGenerator::draw(const std::vector<double>& sums,
+                                            std::size_t first,
+                                            std::size_t last)
+  {
+    const double target{sums[first]+
+                        Uniform(Rng)*(sums[last]-sums[first])};
+    const auto found{std::upper_bound(sums.begin()+first,
+                                      sums.begin()+last+1,target)};
+    const auto index{static_cast<std::size_t>(found-sums.begin())};
+    return std::clamp(index,first+1,last)-1;
+  } // End of draw
+
+  //=========================================================================
+  // Emit the "in" event of the next trip, queue its "out" event and pick
+  // when the trip after it starts.
+  //=========================================================================
+  void PassengerEventGenerator::start_trip(PassengerEvent& event)
+  {
+    const Route& route{Routes[draw(Route_weight_sums,0,Routes.size())]};
+    const std::size_t n_stops{route.Stops.size()};
+    const std::size_t origin{draw(route.Weight_sums,0,n_stops-1)};
+    const std::size_t destination{draw(route.Weight_sums,origin+1,n_stops)};
+
+    event.timestamp=Next_trip;
+    event.station=route.Stops[origin];
+    event.direction=PassengerDirection::In;
+
+    const auto wait{static_cast<std::int64_t>(
+      Uniform(Rng)*Options.max_wait_seconds*1.0e6)};
+    Exits.push_back({Next_trip+wait+route.Arrivals[destination]-
+                     route.Arrivals[origin],route.Stops[destination]});
+    std::push_heap(Exits.begin(),Exits.end(),later<PendingExit>);
+
+    // Exponential gap to the next trip, at the current demand
+    const double rate{Options.trips_per_second*demand(Next_trip)};
+    const double gap{-std::log(1.0-Uniform(Rng))/std::max(rate,1.0e-9)};
+    Next_trip+=std::max<std::int64_t>(1,static_cast<std::int64_t>(gap*1.0e6));
+  } // End of start_trip
+
+  // Free functions
+
+  //===========================================================================
+  /*! \brief Append a passenger event as a STOMP MESSAGE frame, as published
+             on /passengers.
+
+      The body is the JSON object PassengerEventParser reads, and the frame
+      ends with its NULL octet, so frames can be concatenated.
+
+      \param event    The event.
+      \param stations The station index the event's dense ID refers to.
+      \param frame    The string to append to.
+      \param sent_at  If positive, the wall-clock time the frame is
+                      published at, in microseconds since the Unix epoch. It
+                      goes in a sent-at header, for subscribers to measure
+                      the feed latency.
+  */
+  //===========================================================================
+  void append_passenger_event_frame(const PassengerEvent& event,
+                                    const StationIndex& stations,
+                                    std::string& frame,
+                                    std::int64_t sent_at)
+  {
+    frame+="MESSAGE\n"
+           "destination:/passengers\n"
+           "content-type:application/json\n";
+    if (sent_at>0)
+    {
+      frame+="sent-at:";
+      frame+=std::to_string(sent_at);
+      frame.push_back('\n');
+    }
+    frame+="\n"
+           "{\"datetime\":\"";
+    append_iso8601_timestamp(event.timestamp,frame);
+    frame+=(event.direction==PassengerDirection::In) ?
+      "\",\"passenger_event\":\"in\",\"station_id\":\"" :
+      "\",\"passenger_event\":\"out\",\"station_id\":\"";
+    frame+=stations.station_id(event.station);
+    frame+="\"}";
+    frame.push_back('\0');
+  } // End of append_passenger_event_frame
+
+  //===========================================================================
+  /*! \brief Read the sent-at header of a passenger event frame.
+
+      \param frame    The STOMP frame.
+      \param sent_at  Microseconds since the Unix epoch, on success.
+      \returns        false if the frame has no valid sent-at header.
+  */
+  //===========================================================================
+  bool parse_passenger_event_frame_sent_at(std::string_view frame,
+                                           std::int64_t& sent_at)
+  {
+    // Only look at the headers, which end at the first blank line.
+    const std::size_t headers_end{frame.find("\n\n")};
+    const std::string_view headers{frame.substr(0,headers_end)};
+    constexpr std::string_view name{"\nsent-at:"};
+    const std::size_t found{headers.find(name)};
+    if (found==std::string_view::npos)
+    {
+      return false;
+    }
+    const char* first{headers.data()+found+name.size()};
+    const char* last{headers.data()+headers.size()};
+    const auto [end,ec]{std::from_chars(first,last,sent_at)};
+    return (ec==std::errc{}) && (end!=first) &&
+           ((end==last) || (*end=='\n') || (*end=='\r'));
+  } // End of parse_passenger_event_frame_sent_at
+} // namespace NetworkMonitor
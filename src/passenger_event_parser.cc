@@ -0,0 +1,534 @@
+// SIMD intrinsics; the widest instruction set enabled at compile time is used
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Regular libraries
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// The matching header
+#include "network-monitor/passenger_event_parser.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // Find the first '"' or '\' in [first,last). Returns last if none.
+  //===========================================================================
+  static const char* find_quote_or_backslash(const char* first,
+                                             const char* last)
+  {
+#if defined(__AVX2__)
+    const __m256i quotes_32{_mm256_set1_epi8('"')};
+    const __m256i backslashes_32{_mm256_set1_epi8('\\')};
+    while (last-first>=32)
+    {
+      const __m256i chunk{
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first))};
+      const unsigned mask{static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk,quotes_32),
+                        _mm256_cmpeq_epi8(chunk,backslashes_32))))};
+      if (mask!=0)
+      {
+        return first+__builtin_ctz(mask);
+      }
+      first+=32;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i quotes_16{_mm_set1_epi8('"')};
+    const __m128i backslashes_16{_mm_set1_epi8('\\')};
+    while (last-first>=16)
+    {
+      const __m128i chunk{
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(first))};
+      const unsigned mask{static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk,quotes_16),
+                     _mm_cmpeq_epi8(chunk,backslashes_16))))};
+      if (mask!=0)
+      {
+        return first+__builtin_ctz(mask);
+      }
+      first+=16;
+    }
+#endif
+    while ((first<last) && (*first!='"') && (*first!='\\'))
+    {
+      first++;
+    }
+    return first;
+  } // End of find_quote_or_backslash
+
+  //===========================================================================
+  // Skip JSON whitespace
+  //===========================================================================
+  static const char* skip_whitespace(const char* first, const char* last)
+  {
+    while ((first<last) &&
+           ((*first==' ') || (*first=='\n') ||
+            (*first=='\r') || (*first=='\t')))
+    {
+      first++;
+    }
+    return first;
+  } // End of skip_whitespace
+
+  //===========================================================================
+  // Read a string without escape sequences. On entry, p points at the opening
+  // quote; on success, it points past the closing quote.
+  //===========================================================================
+  static bool read_plain_string(const char*& p,
+                                const char* last,
+                                std::string_view& value)
+  {
+    const char* closing{find_quote_or_backslash(p+1,last)};
+    if ((closing==last) || (*closing!='"'))
+    {
+      return false;
+    }
+    value=std::string_view(p+1,static_cast<std::size_t>(closing-p-1));
+    p=closing+1;
+    return true;
+  } // End of read_plain_string
+
+  //===========================================================================
+  // Skip a string that may contain escape sequences. On entry, p points at
+  // the opening quote; on success, it points past the closing quote.
+  //===========================================================================
+  static bool skip_string(const char*& p, const char* last)
+  {
+    p++;
+    while (true)
+    {
+      p=find_quote_or_backslash(p,last);
+      if (p==last)
+      {
+        return false;
+      }
+      if (*p=='"')
+      {
+        p++;
+        return true;
+      }
+
+      // Skip the backslash and the escaped character.
+      p+=2;
+      if (p>last)
+      {
+        return false;
+      }
+    }
+  } // End of skip_string
+
+  //===========================================================================
+  // Skip any JSON value. On success, p points past the value.
+  //===========================================================================
+  static bool skip_value(const char*& p, const char* last)
+  {
+    if (p==last)
+    {
+      return false;
+    }
+    if (*p=='"')
+    {
+      return skip_string(p,last);
+    }
+
+    // Scalars (numbers, true, false, null) end at the next delimiter.
+    if ((*p!='{') && (*p!='['))
+    {
+      while ((p<last) && (*p!=',') && (*p!='}') && (*p!=']') &&
+             (*p!=' ') && (*p!='\n') && (*p!='\r') && (*p!='\t'))
+      {
+        p++;
+      }
+      return true;
+    }
+
+    // Objects and arrays: track the nesting depth, stepping over strings so
+    // that brackets inside them are not counted.
+    int depth{0};
+    while (p<last)
+    {
+      switch (*p)
+      {
+      case '"':
+        if (!skip_string(p,last))
+        {
+          return false;
+        }
+        continue;
+      case '{':
+      case '[':
+        depth++;
+        break;
+      case '}':
+      case ']':
+        depth--;
+        if (depth==0)
+        {
+          p++;
+          return true;
+        }
+        break;
+      default:
+        break;
+      }
+      p++;
+    }
+    return false;
+  } // End of skip_value
+
+  //===========================================================================
+  // Parse a fixed number of decimal digits
+  //===========================================================================
+  static bool parse_digits(const char* p, int n_digits, int& value)
+  {
+    value=0;
+    for (int i=0; i<n_digits; i++)
+    {
+      const unsigned digit{static_cast<unsigned>(p[i]-'0')};
+      if (digit>9)
+      {
+        return false;
+      }
+      value=value*10+static_cast<int>(digit);
+    }
+    return true;
+  } // End of parse_digits
+
+  //===========================================================================
+  // Number of days between 1970-01-01 and the given civil date (proleptic
+  // Gregorian calendar); see http://howardhinnant.github.io/date_algorithms
+  //===========================================================================
+  static std::int64_t days_from_civil(int year, int month, int day)
+  {
+    year-=(month<=2);
+    const int era{(year>=0 ? year : year-399)/400};
+    const int year_of_era{year-era*400};
+    const int day_of_year{(153*(month+(month>2 ? -3 : 9))+2)/5+day-1};
+    const int day_of_era{year_of_era*365+year_of_era/4-year_of_era/100+
+                         day_of_year};
+    return static_cast<std::int64_t>(era)*146097+day_of_era-719468;
+  } // End of days_from_civil
+
+  //===========================================================================
+  // The civil date of a number of days since 1970-01-01; the inverse of
+  // days_from_civil
+  //===========================================================================
+  static void civil_from_days(std::int64_t days,
+                              int& year,
+                              int& month,
+                              int& day)
+  {
+    days+=719468;
+    const std::int64_t era{(days>=0 ? days : days-146096)/146097};
+    const int day_of_era{static_cast<int>(days-era*146097)};
+    const int year_of_era{(day_of_era-day_of_era/1460+day_of_era/36524-
+                           day_of_era/146096)/365};
+    const int day_of_year{day_of_era-(365*year_of_era+year_of_era/4-
+                                      year_of_era/100)};
+    const int month_index{(5*day_of_year+2)/153};
+    day=day_of_year-(153*month_index+2)/5+1;
+    month=month_index+(month_index<10 ? 3 : -9);
+    year=static_cast<int>(year_of_era+era*400)+(month<=2);
+  } // End of civil_from_days
+
+  //===========================================================================
+  // Write a number with a fixed number of digits, zero-padded
+  //===========================================================================
+  static char* write_digits(char* p, int n_digits, std::int64_t value)
+  {
+    for (int i=n_digits-1; i>=0; i--)
+    {
+      p[i]=static_cast<char>('0'+value%10);
+      value/=10;
+    }
+    return p+n_digits;
+  } // End of write_digits
+
+  // Free functions
+
+  //===========================================================================
+  /*! \brief Parse an ISO 8601 UTC timestamp such as
+             "2020-11-01T07:18:50.234000Z".
+
+      \param text       The timestamp. The fractional part and the trailing
+                        'Z' are optional; digits past microseconds are
+                        truncated.
+      \param timestamp  Microseconds since the Unix epoch, on success.
+  */
+  //===========================================================================
+  bool parse_iso8601_timestamp(std::string_view text, std::int64_t& timestamp)
+  {
+    // YYYY-MM-DDTHH:MM:SS
+    if ((text.size()<19) ||
+        (text[4]!='-') || (text[7]!='-') ||
+        ((text[10]!='T') && (text[10]!=' ')) ||
+        (text[13]!=':') || (text[16]!=':'))
+    {
+      return false;
+    }
+
+    int year{0}, month{0}, day{0}, hour{0}, minute{0}, second{0};
+    const char* p{text.data()};
+    if (!parse_digits(p,4,year) || !parse_digits(p+5,2,month) ||
+        !parse_digits(p+8,2,day) || !parse_digits(p+11,2,hour) ||
+        !parse_digits(p+14,2,minute) || !parse_digits(p+17,2,second))
+    {
+      return false;
+    }
+    if ((month<1) || (month>12) || (day<1) || (day>31) ||
+        (hour>23) || (minute>59) || (second>60))
+    {
+      return false;
+    }
+
+    // Optional fractional seconds, then an optional 'Z'.
+    std::size_t i{19};
+    std::int64_t microseconds{0};
+    if ((i<text.size()) && (text[i]=='.'))
+    {
+      i++;
+      int n_digits{0};
+      while ((i<text.size()) &&
+             (static_cast<unsigned>(text[i]-'0')<=9))
+      {
+        if (n_digits<6)
+        {
+          microseconds=microseconds*10+(text[i]-'0');
+        }
+        n_digits++;
+        i++;
+      }
+      if (n_digits==0)
+      {
+        return false;
+      }
+      for (; n_digits<6; n_digits++)
+      {
+        microseconds*=10;
+      }
+    }
+    if ((i<text.size()) && (text[i]=='Z'))
+    {
+      i++;
+    }
+    if (i!=text.size())
+    {
+      return false;
+    }
+
+    const std::int64_t seconds{days_from_civil(year,month,day)*86400+
+                               hour*3600+minute*60+second};
+    timestamp=seconds*1000000+microseconds;
+    return true;
+  } // End of parse_iso8601_timestamp
+
+  //===========================================================================
+  /*! \brief Append a timestamp in the format parse_iso8601_timestamp reads,
+             with microseconds, e.g. "2020-11-01T07:18:50.234000Z".
+
+      \param timestamp  Microseconds since the Unix epoch.
+      \param text       The string to append to.
+  */
+  //===========================================================================
+  void append_iso8601_timestamp(std::int64_t timestamp, std::string& text)
+  {
+    std::int64_t seconds{timestamp/1000000};
+    std::int64_t microseconds{timestamp%1000000};
+    if (microseconds<0)
+    {
+      seconds--;
+      microseconds+=1000000;
+    }
+    std::int64_t days{seconds/86400};
+    std::int64_t second_of_day{seconds%86400};
+    if (second_of_day<0)
+    {
+      days--;
+      second_of_day+=86400;
+    }
+    int year{0}, month{0}, day{0};
+    civil_from_days(days,year,month,day);
+
+    char buffer[27];
+    char* p{buffer};
+    p=write_digits(p,4,year);
+    *p++='-';
+    p=write_digits(p,2,month);
+    *p++='-';
+    p=write_digits(p,2,day);
+    *p++='T';
+    p=write_digits(p,2,second_of_day/3600);
+    *p++=':';
+    p=write_digits(p,2,second_of_day/60%60);
+    *p++=':';
+    p=write_digits(p,2,second_of_day%60);
+    *p++='.';
+    p=write_digits(p,6,microseconds);
+    *p++='Z';
+    text.append(buffer,sizeof(buffer));
+  } // End of append_iso8601_timestamp
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct a parser.
+
+      \param stations The station index used to map station IDs to dense
+                      IDs. It must outlive the parser.
+  */
+  //=========================================================================
+  PassengerEventParser::PassengerEventParser(const StationIndex& stations) :
+    Stations(stations)
+  {} // End of PassengerEventParser
+
+  //=========================================================================
+  /*! \brief Decode the JSON body of a passenger event.
+
+      \param body   The JSON object.
+      \param event  Filled in on success; unspecified otherwise.
+      \returns      false if the body is malformed, a field is missing, or
+                    the station is not in the station index.
+  */
+  //=========================================================================
+  bool PassengerEventParser::parse(std::string_view body,
+                                   PassengerEvent& event) const
+  {
+    // One bit per field we still need.
+    constexpr unsigned has_datetime{1};
+    constexpr unsigned has_direction{2};
+    constexpr unsigned has_station{4};
+    constexpr unsigned has_all{has_datetime|has_direction|has_station};
+    unsigned found{0};
+
+    const char* p{body.data()};
+    const char* const last{p+body.size()};
+    p=skip_whitespace(p,last);
+    if ((p==last) || (*p!='{'))
+    {
+      return false;
+    }
+    p++;
+
+    while (found!=has_all)
+    {
+      p=skip_whitespace(p,last);
+      if ((p!=last) && (*p==','))
+      {
+        p=skip_whitespace(p+1,last);
+      }
+      if ((p==last) || (*p!='"'))
+      {
+        // Either the object ended before we found every field, or the input
+        // is not a well-formed object.
+        return false;
+      }
+
+      std::string_view key{};
+      if (!read_plain_string(p,last,key))
+      {
+        return false;
+      }
+      p=skip_whitespace(p,last);
+      if ((p==last) || (*p!=':'))
+      {
+        return false;
+      }
+      p=skip_whitespace(p+1,last);
+      if (p==last)
+      {
+        return false;
+      }
+
+      // Keys we care about must have a plain string value.
+      std::string_view value{};
+      if (key=="station_id")
+      {
+        if ((*p!='"') || !read_plain_string(p,last,value))
+        {
+          return false;
+        }
+        event.station=Stations.find(value);
+        if (event.station==StationIndex::npos)
+        {
+          return false;
+        }
+        found|=has_station;
+      }
+      else if (key=="passenger_event")
+      {
+        if ((*p!='"') || !read_plain_string(p,last,value))
+        {
+          return false;
+        }
+        if (value=="in")
+        {
+          event.direction=PassengerDirection::In;
+        }
+        else if (value=="out")
+        {
+          event.direction=PassengerDirection::Out;
+        }
+        else
+        {
+          return false;
+        }
+        found|=has_direction;
+      }
+      else if (key=="datetime")
+      {
+        if ((*p!='"') || !read_plain_string(p,last,value) ||
+            !parse_iso8601_timestamp(value,event.timestamp))
+        {
+          return false;
+        }
+        found|=has_datetime;
+      }
+      else if (!skip_value(p,last))
+      {
+        return false;
+      }
+    } // while (found!=has_all)
+
+    return true;
+  } // End of parse
+
+  //=========================================================================
+  /*! \brief Decode a passenger event carried in a STOMP frame.
+
+      \param frame  The whole STOMP frame, as received from the WebSocket.
+                    The body starts after the first blank line and ends at
+                    the NULL octet or at the end of the frame.
+      \param event  Filled in on success; unspecified otherwise.
+  */
+  //=========================================================================
+  bool PassengerEventParser::parse_stomp_frame(std::string_view frame,
+                                               PassengerEvent& event) const
+  {
+    // STOMP allows both LF and CRLF line endings.
+    std::size_t body_start{frame.find("\n\n")};
+    std::size_t separator_size{2};
+    if (body_start==std::string_view::npos)
+    {
+      body_start=frame.find("\r\n\r\n");
+      separator_size=4;
+    }
+    if (body_start==std::string_view::npos)
+    {
+      return false;
+    }
+
+    std::string_view body{frame.substr(body_start+separator_size)};
+    const std::size_t body_end{body.find('\0')};
+    if (body_end!=std::string_view::npos)
+    {
+      body=body.substr(0,body_end);
+    }
+    return parse(body,event);
+  } // End of parse_stomp_frame
+} // namespace NetworkMonitor
@@ -0,0 +1,277 @@
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/system/error_code.hpp>
+
+// Regular libraries
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Headers we've defined
+#include "network-monitor/passenger_event_generator.h"
+
+// The matching header
+#include "network-monitor/passenger_feed_server.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // The value of a STOMP frame header, or an empty view if it is missing
+  //===========================================================================
+  static std::string_view stomp_header(std::string_view frame,
+                                       std::string_view name)
+  {
+    // Headers start on the line after the command and end at a blank line.
+    std::size_t line{frame.find('\n')};
+    while (line!=std::string_view::npos)
+    {
+      line++;
+      std::size_t end{frame.find('\n',line)};
+      if (end==std::string_view::npos)
+      {
+        end=frame.size();
+      }
+      std::string_view header{frame.substr(line,end-line)};
+      if (!header.empty() && (header.back()=='\r'))
+      {
+        header.remove_suffix(1);
+      }
+      if (header.empty())
+      {
+        break;
+      }
+      if ((header.size()>name.size()) && (header[name.size()]==':') &&
+          (header.substr(0,name.size())==name))
+      {
+        return header.substr(name.size()+1);
+      }
+      line=(end<frame.size()) ? end : std::string_view::npos;
+    }
+    return {};
+  } // End of stomp_header
+
+  //===========================================================================
+  // Answer a STOMP frame a client sent before subscribing. Returns true if
+  // the frame subscribes the client to /passengers.
+  //===========================================================================
+  static bool answer_request(const std::string& request, std::string& reply)
+  {
+    const std::string_view frame{request};
+    std::string_view command{frame.substr(0,frame.find('\n'))};
+    if (!command.empty() && (command.back()=='\r'))
+    {
+      command.remove_suffix(1);
+    }
+
+    if ((command=="CONNECT") || (command=="STOMP"))
+    {
+      reply="CONNECTED\n"
+            "version:1.2\n"
+            "\n";
+      reply.push_back('\0');
+      return false;
+    }
+    if (command=="SUBSCRIBE")
+    {
+      if (stomp_header(frame,"destination")!="/passengers")
+      {
+        reply="ERROR\n"
+              "message:Unknown destination\n"
+              "\n";
+        reply.push_back('\0');
+        return false;
+      }
+      const std::string_view receipt{stomp_header(frame,"receipt")};
+      if (!receipt.empty())
+      {
+        reply="RECEIPT\n"
+              "receipt-id:";
+        reply+=receipt;
+        reply+="\n\n";
+        reply.push_back('\0');
+      }
+      return true;
+    }
+
+    // DISCONNECT, heart-beats and anything else go unanswered.
+    return false;
+  } // End of answer_request
+
+  //===========================================================================
+  // The wall-clock time, in microseconds since the Unix epoch
+  //===========================================================================
+  static std::int64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  } // End of now
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct a plain WebSocket feed server.
+
+      \note This constructor does not start listening for connections.
+
+      \param ip             The IP address to listen on.
+      \param port           The port to listen on; 0 picks a free port.
+      \param ioc            The io_context object. The user takes care of
+                            calling ioc.run(), from one or more threads.
+      \param stations       The station index of the published events. It
+                            must outlive the server.
+      \param max_queue_size The maximum number of messages queued for one
+                            subscriber.
+      \param policy         What to do when a subscriber queue is full.
+  */
+  //=========================================================================
+  PassengerFeedServer::PassengerFeedServer(
+    const std::string& ip,
+    unsigned short port,
+    boost::asio::io_context& ioc,
+    const StationIndex& stations,
+    std::size_t max_queue_size,
+    WebSocketServer::SlowClientPolicy policy) :
+    Stations(stations),
+    Server(ip,port,ioc,max_queue_size,policy)
+  {} // End of PassengerFeedServer
+
+  //=========================================================================
+  /*! \brief Construct a feed server over TLS.
+
+      \note This constructor does not start listening for connections.
+
+      \param ip             The IP address to listen on.
+      \param port           The port to listen on; 0 picks a free port.
+      \param ioc            The io_context object. The user takes care of
+                            calling ioc.run(), from one or more threads.
+      \param ctx            The TLS server context. It must outlive the
+                            server.
+      \param stations       The station index of the published events. It
+                            must outlive the server.
+      \param max_queue_size The maximum number of messages queued for one
+                            subscriber.
+      \param policy         What to do when a subscriber queue is full.
+  */
+  //=========================================================================
+  PassengerFeedServer::PassengerFeedServer(
+    const std::string& ip,
+    unsigned short port,
+    boost::asio::io_context& ioc,
+    boost::asio::ssl::context& ctx,
+    const StationIndex& stations,
+    std::size_t max_queue_size,
+    WebSocketServer::SlowClientPolicy policy) :
+    Stations(stations),
+    Server(ip,port,ioc,ctx,max_queue_size,policy)
+  {} // End of PassengerFeedServer
+
+  //=========================================================================
+  /*! \brief Start accepting clients.
+
+      \param on_subscribe   Called when a client fails its handshake, or
+                            subscribes to /passengers.
+      \param on_unsubscribe Called when a subscriber disconnects or is
+                            disconnected.
+      \returns              An error if the server could not listen on the
+                            requested address.
+  */
+  //=========================================================================
+  boost::system::error_code PassengerFeedServer::run(
+    std::function<void (boost::system::error_code)> on_subscribe,
+    std::function<void (boost::system::error_code)> on_unsubscribe)
+  {
+    return Server.run(on_subscribe,on_unsubscribe,answer_request);
+  } // End of run
+
+  //=========================================================================
+  /*! \brief Stop accepting clients and disconnect the current ones.
+  */
+  //=========================================================================
+  void PassengerFeedServer::stop()
+  {
+    Server.stop();
+  } // End of stop
+
+  //=========================================================================
+  /*! \brief Publish an event as one WebSocket message, as the live feed
+             does.
+
+      \note This function is thread-safe.
+  */
+  //=========================================================================
+  void PassengerFeedServer::publish(const PassengerEvent& event)
+  {
+    std::string frame{};
+    append_passenger_event_frame(event,Stations,frame,now());
+    Server.broadcast(std::move(frame));
+  } // End of publish
+
+  //=========================================================================
+  /*! \brief Publish several events as consecutive STOMP frames in one
+             WebSocket message.
+
+      This amortises the per-message cost, but subscribers must split the
+      message on the NULL octets: parse_stomp_frame only reads the first
+      frame.
+
+      \note This function is thread-safe.
+  */
+  //=========================================================================
+  void PassengerFeedServer::publish(const std::vector<PassengerEvent>& events)
+  {
+    if (events.empty())
+    {
+      return;
+    }
+    const std::int64_t sent_at{now()};
+    std::string frames{};
+    for (const auto& event : events)
+    {
+      append_passenger_event_frame(event,Stations,frames,sent_at);
+    }
+    Server.broadcast(std::move(frames));
+  } // End of publish
+
+  //=========================================================================
+  /*! \brief The number of clients subscribed to /passengers.
+  */
+  //=========================================================================
+  std::size_t PassengerFeedServer::subscriber_count() const
+  {
+    return Server.subscriber_count();
+  } // End of subscriber_count
+
+  //=========================================================================
+  /*! \brief The number of messages dropped because a subscriber queue was
+             full. Only final once pending_message_count() is zero.
+  */
+  //=========================================================================
+  std::size_t PassengerFeedServer::dropped_message_count() const
+  {
+    return Server.dropped_message_count();
+  } // End of dropped_message_count
+
+  //=========================================================================
+  /*! \brief The number of messages queued or being written, summed over
+             the subscribers.
+  */
+  //=========================================================================
+  std::size_t PassengerFeedServer::pending_message_count() const
+  {
+    return Server.pending_message_count();
+  } // End of pending_message_count
+
+  //=========================================================================
+  /*! \brief The port the server listens on, once run() has succeeded.
+  */
+  //=========================================================================
+  unsigned short PassengerFeedServer::port() const
+  {
+    return Server.port();
+  } // End of port
+} // namespace NetworkMonitor
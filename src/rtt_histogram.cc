@@ -0,0 +1,144 @@
+// Regular libraries
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// The matching header
+#include "network-monitor/rtt_histogram.h"
+
+namespace NetworkMonitor
+{
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct an empty histogram.
+
+      \param window The number of recent samples the histogram covers.
+  */
+  //=========================================================================
+  RttHistogram::RttHistogram(std::size_t window) :
+    Samples(std::max<std::size_t>(window,1),0)
+  {} // End of RttHistogram
+
+  //=========================================================================
+  /*! \brief Add a sample, evicting the oldest one if the window is full.
+  */
+  //=========================================================================
+  void RttHistogram::record(std::chrono::microseconds rtt)
+  {
+    const std::int64_t sample{std::max<std::int64_t>(rtt.count(),0)};
+    if (Count==Samples.size())
+    {
+      Counts[bucket(Samples[Next])]--;
+    }
+    else
+    {
+      Count++;
+    }
+    Samples[Next]=sample;
+    Counts[bucket(sample)]++;
+    Next=(Next+1)%Samples.size();
+  } // End of record
+
+  //=========================================================================
+  /*! \brief Remove every sample.
+  */
+  //=========================================================================
+  void RttHistogram::clear()
+  {
+    Next=0;
+    Count=0;
+    Counts.fill(0);
+  } // End of clear
+
+  //=========================================================================
+  /*! \brief The number of samples in the window.
+  */
+  //=========================================================================
+  std::size_t RttHistogram::count() const
+  {
+    return Count;
+  } // End of count
+
+  //=========================================================================
+  /*! \brief Estimate a percentile of the samples in the window.
+
+      \param fraction The percentile as a fraction, e.g. 0.5 for the
+                      median or 0.99 for the 99th percentile.
+      \returns        Zero if the histogram is empty.
+  */
+  //=========================================================================
+  std::chrono::microseconds RttHistogram::percentile(double fraction) const
+  {
+    if (Count==0)
+    {
+      return std::chrono::microseconds(0);
+    }
+
+    // Rank of the sample we are looking for, starting at 1
+    fraction=std::clamp(fraction,0.0,1.0);
+    const std::size_t rank{std::max<std::size_t>(
+      1,static_cast<std::size_t>(fraction*static_cast<double>(Count)+0.5))};
+    std::size_t seen{0};
+    for (std::size_t b=0; b<N_buckets; b++)
+    {
+      seen+=Counts[b];
+      if (seen>=rank)
+      {
+        return std::chrono::microseconds(bucket_value(b));
+      }
+    }
+    return std::chrono::microseconds(bucket_value(N_buckets-1));
+  } // End of percentile
+
+  //=========================================================================
+  /*! \brief The most recent sample, or zero if the histogram is empty.
+  */
+  //=========================================================================
+  std::chrono::microseconds RttHistogram::last() const
+  {
+    if (Count==0)
+    {
+      return std::chrono::microseconds(0);
+    }
+    return std::chrono::microseconds(
+      Samples[(Next+Samples.size()-1)%Samples.size()]);
+  } // End of last
+
+  // Private methods
+
+  //=========================================================================
+  // Values below 16 us get a bucket each. Above that, a value with its top
+  // bit at position e lands in one of four buckets, chosen by the two bits
+  // below the top one.
+  //=========================================================================
+  std::size_t RttHistogram::bucket(std::int64_t microseconds)
+  {
+    const auto value{static_cast<std::uint64_t>(microseconds)};
+    if (value<16)
+    {
+      return static_cast<std::size_t>(value);
+    }
+    const int top_bit{63-__builtin_clzll(value)};
+    const std::uint64_t sub_bucket{(value>>(top_bit-2))&3};
+    return std::min<std::size_t>(
+      16+static_cast<std::size_t>(top_bit-4)*4+sub_bucket,N_buckets-1);
+  } // End of bucket
+
+  //=========================================================================
+  // The middle of the range of values that fall in a bucket
+  //=========================================================================
+  std::int64_t RttHistogram::bucket_value(std::size_t bucket)
+  {
+    if (bucket<16)
+    {
+      return static_cast<std::int64_t>(bucket);
+    }
+    const int top_bit{static_cast<int>((bucket-16)/4)+4};
+    const std::uint64_t sub_bucket{(bucket-16)%4};
+    const std::uint64_t lower{(4+sub_bucket)<<(top_bit-2)};
+    const std::uint64_t width{std::uint64_t{1}<<(top_bit-2)};
+    return static_cast<std::int64_t>(lower+width/2);
+  } // End of bucket_value
+} // namespace NetworkMonitor
@@ -0,0 +1,245 @@
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// The matching header
+#include "network-monitor/station_index.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // Finaliser from MurmurHash3
+  //===========================================================================
+  static std::uint64_t mix(std::uint64_t hash)
+  {
+    hash^=hash>>33;
+    hash*=0xff51afd7ed558ccdULL;
+    hash^=hash>>33;
+    hash*=0xc4ceb9fe1a85ec53ULL;
+    hash^=hash>>33;
+    return hash;
+  } // End of mix
+
+  //===========================================================================
+  // 64-bit FNV-1a hash of a string. Station IDs only differ in their last few
+  // characters, which FNV leaves in the low bits; the finaliser spreads them
+  // over the high bits that reduce() uses.
+  //===========================================================================
+  static std::uint64_t hash_key(std::string_view key)
+  {
+    std::uint64_t hash{0xcbf29ce484222325ULL};
+    for (const unsigned char c : key)
+    {
+      hash^=c;
+      hash*=0x100000001b3ULL;
+    }
+    return mix(hash);
+  } // End of hash_key
+
+  //===========================================================================
+  // Map a 64-bit hash onto [0,n) without a division
+  //===========================================================================
+  static std::size_t reduce(std::uint64_t hash, std::size_t n)
+  {
+    return static_cast<std::size_t>(
+      ((hash>>32)*static_cast<std::uint64_t>(n))>>32);
+  } // End of reduce
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct the index from a list of station IDs.
+
+      \param station_ids  The station IDs; the dense ID of a station is its
+                          position in this list. Duplicates are ignored.
+  */
+  //=========================================================================
+  StationIndex::StationIndex(const std::vector<std::string>& station_ids)
+  {
+    std::unordered_set<std::string_view> seen{};
+    Station_ids.reserve(station_ids.size());
+    for (const auto& station_id : station_ids)
+    {
+      if (seen.insert(station_id).second)
+      {
+        Station_ids.push_back(station_id);
+      }
+    }
+    build();
+  } // End of StationIndex
+
+  //=========================================================================
+  /*! \brief Construct the index from the "stations" list of a network
+             layout.
+
+      \param network_layout The parsed network-layout.json file. If it has
+                            no "stations" list, the index is empty.
+  */
+  //=========================================================================
+  StationIndex::StationIndex(const nlohmann::json& network_layout)
+  {
+    if (!network_layout.contains("stations"))
+    {
+      return;
+    }
+
+    std::unordered_set<std::string> seen{};
+    for (const auto& station : network_layout.at("stations"))
+    {
+      auto station_id{station.at("station_id").get<std::string>()};
+      if (seen.insert(station_id).second)
+      {
+        Station_ids.push_back(std::move(station_id));
+      }
+    }
+    build();
+  } // End of StationIndex
+
+  //=========================================================================
+  /*! \brief Get the dense ID of a station.
+
+      \param station_id The station ID, e.g. "station_042".
+      \returns          The dense ID, or StationIndex::npos.
+  */
+  //=========================================================================
+  std::uint32_t StationIndex::find(std::string_view station_id) const
+  {
+    if (Station_ids.empty())
+    {
+      return npos;
+    }
+
+    const std::uint64_t hash{hash_key(station_id)};
+    const std::uint32_t index{Slots[slot(hash,Pilots[bucket(hash)])]};
+    if ((index==npos) || (Station_ids[index]!=station_id))
+    {
+      return npos;
+    }
+    return index;
+  } // End of find
+
+  //=========================================================================
+  /*! \brief Get the station ID corresponding to a dense ID.
+
+      \param index  A dense ID in [0,size()).
+  */
+  //=========================================================================
+  const std::string& StationIndex::station_id(std::uint32_t index) const
+  {
+    return Station_ids[index];
+  } // End of station_id
+
+  //=========================================================================
+  /*! \brief The number of stations in the index.
+  */
+  //=========================================================================
+  std::size_t StationIndex::size() const
+  {
+    return Station_ids.size();
+  } // End of size
+
+  // Private methods
+
+  //=========================================================================
+  // Hash-and-displace construction: keys are grouped into small buckets and,
+  // largest bucket first, we search for a displacement ("pilot") that sends
+  // every key of the bucket to a free slot.
+  //=========================================================================
+  void StationIndex::build()
+  {
+    const std::size_t n_keys{Station_ids.size()};
+    if (n_keys==0)
+    {
+      return;
+    }
+
+    // Average of ~4 keys per bucket, ~80% slot occupancy.
+    const std::size_t n_buckets{(n_keys+3)/4};
+    const std::size_t n_slots{n_keys+n_keys/4+1};
+    Pilots.assign(n_buckets,0);
+    Slots.assign(n_slots,npos);
+
+    // Hash every key once and group the keys by bucket.
+    std::vector<std::uint64_t> hashes(n_keys);
+    std::vector<std::vector<std::uint32_t>> buckets(n_buckets);
+    for (std::size_t i=0; i<n_keys; i++)
+    {
+      hashes[i]=hash_key(Station_ids[i]);
+      buckets[bucket(hashes[i])].push_back(static_cast<std::uint32_t>(i));
+    }
+
+    // Place the largest buckets first while the table is still mostly empty.
+    std::vector<std::size_t> order(n_buckets);
+    std::iota(order.begin(),order.end(),0);
+    std::stable_sort(order.begin(),order.end(),
+                     [&buckets](std::size_t a, std::size_t b)
+    {
+      return buckets[a].size()>buckets[b].size();
+    });
+
+    std::vector<std::size_t> candidate_slots{};
+    for (const std::size_t b : order)
+    {
+      const auto& keys{buckets[b]};
+      if (keys.empty())
+      {
+        break;
+      }
+
+      for (std::uint32_t pilot=0; ; pilot++)
+      {
+        // Every key must land on a free slot, and on a different one.
+        candidate_slots.clear();
+        bool placed{true};
+        for (const std::uint32_t key : keys)
+        {
+          const std::size_t s{slot(hashes[key],pilot)};
+          if ((Slots[s]!=npos) ||
+              (std::find(candidate_slots.begin(),candidate_slots.end(),s)!=
+               candidate_slots.end()))
+          {
+            placed=false;
+            break;
+          }
+          candidate_slots.push_back(s);
+        }
+
+        if (placed)
+        {
+          Pilots[b]=pilot;
+          for (std::size_t k=0; k<keys.size(); k++)
+          {
+            Slots[candidate_slots[k]]=keys[k];
+          }
+          break;
+        }
+      } // for (std::uint32_t pilot=0; ; pilot++)
+    } // for (const std::size_t b : order)
+  } // End of build
+
+  //=========================================================================
+  //
+  //=========================================================================
+  std::size_t StationIndex::slot(std::uint64_t hash, std::uint32_t pilot) const
+  {
+    return reduce(mix(hash^(pilot*0x9E3779B97F4A7C15ULL)),Slots.size());
+  } // End of slot
+
+  //=========================================================================
+  //
+  //=========================================================================
+  std::size_t StationIndex::bucket(std::uint64_t hash) const
+  {
+    return reduce(hash,Pilots.size());
+  } // End of bucket
+} // namespace NetworkMonitor
@@ -0,0 +1,646 @@
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The matching header
+#include "network-monitor/station_search.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // Number of candidates of a fuzzy query that we compute the edit distance
+  // of, out of those sharing the most trigrams with it
+  //===========================================================================
+  static constexpr std::size_t Max_fuzzy_candidates{32};
+
+  //===========================================================================
+  // Lower case words separated by single spaces. "&" becomes "and", and
+  // apostrophes disappear so that "Queen's" reads "queens". Bytes outside
+  // ASCII (UTF-8) are kept as they are.
+  //===========================================================================
+  static std::string normalize(std::string_view text)
+  {
+    std::string normalized{};
+    normalized.reserve(text.size());
+    bool space{false};
+    auto append{[&normalized,&space](char c)
+    {
+      if (space && !normalized.empty())
+      {
+        normalized.push_back(' ');
+      }
+      space=false;
+      normalized.push_back(c);
+    }};
+    for (const char c : text)
+    {
+      const auto byte{static_cast<unsigned char>(c)};
+      if ((byte>='A') && (byte<='Z'))
+      {
+        append(static_cast<char>(byte-'A'+'a'));
+      }
+      else if (((byte>='a') && (byte<='z')) || ((byte>='0') && (byte<='9')) ||
+               (byte>=0x80))
+      {
+        append(c);
+      }
+      else if (byte=='&')
+      {
+        space=true;
+        append('a');
+        append('n');
+        append('d');
+        space=true;
+      }
+      else if ((byte!='\'') && (byte!='`'))
+      {
+        space=true;
+      }
+    }
+    return normalized;
+  } // End of normalize
+
+  //===========================================================================
+  // The distinct trigrams of a normalised text, each word padded with a
+  // space on both sides
+  //===========================================================================
+  static std::vector<std::uint32_t> trigrams(std::string_view normalized)
+  {
+    std::vector<std::uint32_t> grams{};
+    std::size_t begin{0};
+    while (begin<normalized.size())
+    {
+      std::size_t end{normalized.find(' ',begin)};
+      if (end==std::string_view::npos)
+      {
+        end=normalized.size();
+      }
+      const std::string padded{" "+std::string(normalized.substr(
+        begin,end-begin))+" "};
+      for (std::size_t i=0; i+3<=padded.size(); i++)
+      {
+        std::uint32_t gram{0};
+        for (std::size_t j=i; j<i+3; j++)
+        {
+          gram=(gram<<8)|static_cast<unsigned char>(padded[j]);
+        }
+        grams.push_back(gram);
+      }
+      begin=end+1;
+    }
+    std::sort(grams.begin(),grams.end());
+    grams.erase(std::unique(grams.begin(),grams.end()),grams.end());
+    return grams;
+  } // End of trigrams
+
+  //===========================================================================
+  // Longest fuzzy query, in normalised characters: one bit per character in
+  // the edit distance computation
+  //===========================================================================
+  static constexpr std::size_t Max_fuzzy_query{64};
+
+  //===========================================================================
+  // Edit distance between a query and the closest substring of a text: the
+  // match may start and end anywhere in the text for free. This is Myers'
+  // bit-parallel algorithm, which processes a whole column of the dynamic
+  // programming matrix per text character. Match masks are built once per
+  // query: bit i of masks[c] is set if query[i] is c.
+  //===========================================================================
+  static unsigned substring_distance(
+    std::size_t query_size,
+    const std::array<std::uint64_t,256>& masks,
+    std::string_view text)
+  {
+    const std::uint64_t last{std::uint64_t{1}<<(query_size-1)};
+    std::uint64_t positive{~std::uint64_t{0}};
+    std::uint64_t negative{0};
+    unsigned score{static_cast<unsigned>(query_size)};
+    unsigned best{score};
+    for (const char c : text)
+    {
+      const std::uint64_t equal{masks[static_cast<unsigned char>(c)]};
+      const std::uint64_t xv{equal|negative};
+      const std::uint64_t xh{(((equal&positive)+positive)^positive)|equal};
+      std::uint64_t ph{negative|~(xh|positive)};
+      std::uint64_t mh{positive&xh};
+      if (ph&last)
+      {
+        score++;
+      }
+      else if (mh&last)
+      {
+        score--;
+      }
+
+      // The match can start anywhere: row 0 stays at zero.
+      ph<<=1;
+      mh<<=1;
+      positive=mh|~(xv|ph);
+      negative=ph&xv;
+      best=std::min(best,score);
+    }
+    return best;
+  } // End of substring_distance
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Build the index of a layout.
+
+      \param network_layout   The parsed network-layout.json file.
+      \param max_suggestions  The most results a prefix query can return.
+  */
+  //=========================================================================
+  StationSearch::StationSearch(const nlohmann::json& network_layout,
+                               std::size_t max_suggestions) :
+    Max_suggestions(std::clamp<std::size_t>(max_suggestions,1,255))
+  {
+    reload(network_layout);
+  } // End of StationSearch
+
+  //=========================================================================
+  /*! \brief Bring the index up to date with a new version of the layout.
+
+      \returns  The number of stations added, renamed or removed.
+  */
+  //=========================================================================
+  std::size_t StationSearch::reload(const nlohmann::json& network_layout)
+  {
+    std::size_t changed{0};
+    std::unordered_set<std::uint32_t> seen{};
+    const auto stations{network_layout.find("stations")};
+    if ((stations!=network_layout.end()) && stations->is_array())
+    {
+      for (const auto& station : *stations)
+      {
+        const auto id{station.find("station_id")};
+        const auto name{station.find("name")};
+        if ((id==station.end()) || (name==station.end()) ||
+            !id->is_string() || !name->is_string())
+        {
+          continue;
+        }
+        const std::string& station_id{id->get_ref<const std::string&>()};
+        const std::string& station_name{name->get_ref<const std::string&>()};
+
+        const auto found{Slot_of_station.find(station_id)};
+        if (found!=Slot_of_station.end())
+        {
+          seen.insert(found->second);
+          if (Slots[found->second].Name==station_name)
+          {
+            continue;
+          }
+          unindex_slot(found->second);
+          Slots[found->second].Name=station_name;
+          index_slot(found->second);
+          changed++;
+          continue;
+        }
+
+        std::uint32_t slot{0};
+        if (!Free_slots.empty())
+        {
+          slot=Free_slots.back();
+          Free_slots.pop_back();
+        }
+        else
+        {
+          slot=static_cast<std::uint32_t>(Slots.size());
+          Slots.emplace_back();
+        }
+        Slots[slot].Station_id=station_id;
+        Slots[slot].Name=station_name;
+        Slot_of_station[station_id]=slot;
+        index_slot(slot);
+        seen.insert(slot);
+        changed++;
+      }
+    }
+
+    // Stations that are gone
+    for (std::uint32_t slot=0; slot<Slots.size(); slot++)
+    {
+      if (Slots[slot].Live && (seen.count(slot)==0))
+      {
+        unindex_slot(slot);
+        Slot_of_station.erase(Slots[slot].Station_id);
+        Slots[slot]=Slot{};
+        Free_slots.push_back(slot);
+        changed++;
+      }
+    }
+
+    for (std::size_t first=0; first<Shards.size(); first++)
+    {
+      if (Dirty_shards[first])
+      {
+        build_shard(static_cast<unsigned char>(first));
+      }
+    }
+    Dirty_shards.reset();
+    return changed;
+  } // End of reload
+
+  //=========================================================================
+  /*! \brief The stations with a word starting with the query, best first.
+  */
+  //=========================================================================
+  std::vector<StationMatch> StationSearch::prefix_search(
+    std::string_view query,
+    std::size_t limit) const
+  {
+    std::vector<StationMatch> matches{};
+    const std::string normalized{normalize(query)};
+    if (normalized.empty())
+    {
+      return matches;
+    }
+    const Shard& shard{Shards[static_cast<unsigned char>(normalized[0])]};
+    if (shard.Nodes.empty())
+    {
+      return matches;
+    }
+
+    // One step down the trie per character
+    const auto& nodes{shard.Nodes};
+    std::uint32_t node{0};
+    for (const char c : std::string_view{normalized}.substr(1))
+    {
+      const Node& parent{nodes[node]};
+      const auto begin{nodes.begin()+parent.First_child};
+      const auto end{begin+parent.N_children};
+      const auto child{std::lower_bound(begin,end,c,
+                                        [](const Node& n, char label)
+      {
+        return static_cast<unsigned char>(n.Label)<
+               static_cast<unsigned char>(label);
+      })};
+      if ((child==end) || (child->Label!=c))
+      {
+        return matches;
+      }
+      node=static_cast<std::uint32_t>(child-nodes.begin());
+    }
+
+    const Node& found{nodes[node]};
+    const std::size_t n{std::min<std::size_t>(found.N_suggestions,limit)};
+    matches.reserve(n);
+    for (std::size_t i=0; i<n; i++)
+    {
+      matches.push_back(match(shard.Suggestions[found.First_suggestion+i],0));
+    }
+    return matches;
+  } // End of prefix_search
+
+  //=========================================================================
+  /*! \brief The stations whose name is closest to the query, allowing
+             about one typo every four characters, best first.
+
+      Only the first 64 characters of the query are used.
+  */
+  //=========================================================================
+  std::vector<StationMatch> StationSearch::fuzzy_search(
+    std::string_view query,
+    std::size_t limit) const
+  {
+    std::vector<StationMatch> matches{};
+    std::string normalized{normalize(query)};
+    if (normalized.empty())
+    {
+      return matches;
+    }
+    if (normalized.size()>Max_fuzzy_query)
+    {
+      normalized.resize(Max_fuzzy_query);
+    }
+
+    // Let the trigrams of the query vote. Trigrams shared by most stations
+    // ("und", "ion", ...) carry little signal and cost the most, so they
+    // only vote if the query has nothing else.
+    const std::vector<std::uint32_t> grams{trigrams(normalized)};
+    std::vector<const std::vector<std::uint32_t>*> lists{};
+    std::vector<const std::vector<std::uint32_t>*> common_lists{};
+    for (const std::uint32_t gram : grams)
+    {
+      const auto found{Postings.find(gram)};
+      if (found==Postings.end())
+      {
+        continue;
+      }
+      if (2*found->second.size()>N_live)
+      {
+        common_lists.push_back(&found->second);
+      }
+      else
+      {
+        lists.push_back(&found->second);
+      }
+    }
+    if (lists.empty())
+    {
+      lists.swap(common_lists);
+    }
+
+    std::vector<std::uint16_t> votes(Slots.size(),0);
+    std::vector<std::uint32_t> candidates{};
+    for (const auto* list : lists)
+    {
+      for (const std::uint32_t slot : *list)
+      {
+        if (votes[slot]++==0)
+        {
+          candidates.push_back(slot);
+        }
+      }
+    }
+
+    // Each typo breaks at most three trigrams (q-gram lemma), so names with
+    // too few votes cannot be within the distance we accept.
+    const unsigned max_distance{std::max<unsigned>(
+      1,static_cast<unsigned>(normalized.size()/4))};
+    if (lists.size()>3*max_distance)
+    {
+      const std::size_t min_votes{lists.size()-3*max_distance};
+      candidates.erase(std::remove_if(candidates.begin(),candidates.end(),
+                                      [&votes,min_votes](std::uint32_t slot)
+      {
+        return votes[slot]<min_votes;
+      }),candidates.end());
+    }
+
+    const auto more_votes{[&votes](std::uint32_t a, std::uint32_t b)
+    {
+      return (votes[a]>votes[b]) || ((votes[a]==votes[b]) && (a<b));
+    }};
+    if (candidates.size()>Max_fuzzy_candidates)
+    {
+      std::nth_element(candidates.begin(),
+                       candidates.begin()+Max_fuzzy_candidates,
+                       candidates.end(),more_votes);
+      candidates.resize(Max_fuzzy_candidates);
+    }
+
+    // Rank by edit distance, then by votes and name length.
+    std::array<std::uint64_t,256> masks{};
+    for (std::size_t i=0; i<normalized.size(); i++)
+    {
+      masks[static_cast<unsigned char>(normalized[i])]|=std::uint64_t{1}<<i;
+    }
+    std::vector<std::tuple<unsigned,int,std::size_t,std::uint32_t>> ranked{};
+    for (const std::uint32_t slot : candidates)
+    {
+      const unsigned distance{substring_distance(
+        normalized.size(),masks,Slots[slot].Normalized)};
+      if (distance<=max_distance)
+      {
+        ranked.emplace_back(distance,-static_cast<int>(votes[slot]),
+                            Slots[slot].Normalized.size(),slot);
+      }
+    }
+    std::sort(ranked.begin(),ranked.end());
+
+    const std::size_t n{std::min(ranked.size(),limit)};
+    matches.reserve(n);
+    for (std::size_t i=0; i<n; i++)
+    {
+      matches.push_back(match(std::get<3>(ranked[i]),std::get<0>(ranked[i])));
+    }
+    return matches;
+  } // End of fuzzy_search
+
+  //=========================================================================
+  /*! \brief Prefix matches, completed with fuzzy matches if there are
+             fewer than limit of them.
+  */
+  //=========================================================================
+  std::vector<StationMatch> StationSearch::search(std::string_view query,
+                                                  std::size_t limit) const
+  {
+    std::vector<StationMatch> matches{prefix_search(query,limit)};
+    if (matches.size()>=limit)
+    {
+      return matches;
+    }
+    for (const auto& fuzzy : fuzzy_search(query,limit))
+    {
+      const bool duplicate{std::any_of(matches.begin(),matches.end(),
+                                       [&fuzzy](const StationMatch& m)
+      {
+        return m.station_id==fuzzy.station_id;
+      })};
+      if (!duplicate)
+      {
+        matches.push_back(fuzzy);
+        if (matches.size()==limit)
+        {
+          break;
+        }
+      }
+    }
+    return matches;
+  } // End of search
+
+  //=========================================================================
+  /*! \brief The number of stations in the index.
+  */
+  //=========================================================================
+  std::size_t StationSearch::size() const
+  {
+    return N_live;
+  } // End of size
+
+  // Private methods
+
+  //=========================================================================
+  // Normalise the name of a slot and add it to the posting lists
+  //=========================================================================
+  void StationSearch::index_slot(std::uint32_t slot)
+  {
+    Slot& entry{Slots[slot]};
+    entry.Normalized=normalize(entry.Name);
+    entry.Trigrams=trigrams(entry.Normalized);
+    entry.Live=true;
+    mark_dirty(slot);
+    for (const std::uint32_t gram : entry.Trigrams)
+    {
+      Postings[gram].push_back(slot);
+    }
+    N_live++;
+  } // End of index_slot
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void StationSearch::unindex_slot(std::uint32_t slot)
+  {
+    Slot& entry{Slots[slot]};
+    mark_dirty(slot);
+    for (const std::uint32_t gram : entry.Trigrams)
+    {
+      auto& list{Postings[gram]};
+      list.erase(std::find(list.begin(),list.end(),slot));
+      if (list.empty())
+      {
+        Postings.erase(gram);
+      }
+    }
+    entry.Trigrams.clear();
+    entry.Live=false;
+    N_live--;
+  } // End of unindex_slot
+
+  //=========================================================================
+  // Flag the shards holding a word of the normalised name of a slot
+  //=========================================================================
+  void StationSearch::mark_dirty(std::uint32_t slot)
+  {
+    const std::string_view text{Slots[slot].Normalized};
+    for (std::size_t begin=0; begin<text.size();)
+    {
+      Dirty_shards.set(static_cast<unsigned char>(text[begin]));
+      const std::size_t space{text.find(' ',begin)};
+      begin=(space==std::string_view::npos) ? text.size() : space+1;
+    }
+  } // End of mark_dirty
+
+  //=========================================================================
+  // Sort the keys starting with a character and lay their part of the trie
+  // out from them
+  //=========================================================================
+  void StationSearch::build_shard(unsigned char first)
+  {
+    std::vector<Key> keys{};
+    for (std::uint32_t slot=0; slot<Slots.size(); slot++)
+    {
+      if (!Slots[slot].Live)
+      {
+        continue;
+      }
+      const std::string_view text{Slots[slot].Normalized};
+      std::uint32_t word{0};
+      for (std::size_t begin=0; begin<text.size(); word++)
+      {
+        if (static_cast<unsigned char>(text[begin])==first)
+        {
+          keys.push_back({text.substr(begin),slot,word});
+        }
+        const std::size_t space{text.find(' ',begin)};
+        begin=(space==std::string_view::npos) ? text.size() : space+1;
+      }
+    }
+
+    Shard& shard{Shards[first]};
+    shard.Nodes.clear();
+    shard.Suggestions.clear();
+    if (keys.empty())
+    {
+      return;
+    }
+    std::sort(keys.begin(),keys.end(),[](const Key& a, const Key& b)
+    {
+      return a.Text<b.Text;
+    });
+    shard.Nodes.assign(1,Node{});
+    shard.Nodes[0].Label=static_cast<char>(first);
+    build_node(shard,0,keys,0,keys.size(),1);
+  } // End of build_shard
+
+  //=========================================================================
+  // Fill in the node for the keys [begin, end), which share their first
+  // depth characters, and then its children. Children are laid out next to
+  // each other so that a node only stores where the first one is.
+  //=========================================================================
+  void StationSearch::build_node(Shard& shard,
+                                 std::uint32_t node,
+                                 const std::vector<Key>& keys,
+                                 std::size_t begin,
+                                 std::size_t end,
+                                 std::size_t depth)
+  {
+    // The best stations below this node: matches on the first word before
+    // the others, then shorter names, one entry per station.
+    std::vector<std::tuple<bool,std::size_t,std::uint32_t>> ranked{};
+    ranked.reserve(end-begin);
+    for (std::size_t k=begin; k<end; k++)
+    {
+      ranked.emplace_back(keys[k].Word>0,
+                          Slots[keys[k].Index].Normalized.size(),
+                          keys[k].Index);
+    }
+    std::sort(ranked.begin(),ranked.end());
+    auto& nodes{shard.Nodes};
+    auto& suggestions{shard.Suggestions};
+    nodes[node].First_suggestion=static_cast<std::uint32_t>(suggestions.size());
+    std::size_t n_suggestions{0};
+    std::unordered_set<std::uint32_t> suggested{};
+    for (const auto& entry : ranked)
+    {
+      if (n_suggestions==Max_suggestions)
+      {
+        break;
+      }
+      if (suggested.insert(std::get<2>(entry)).second)
+      {
+        suggestions.push_back(std::get<2>(entry));
+        n_suggestions++;
+      }
+    }
+    nodes[node].N_suggestions=static_cast<std::uint8_t>(n_suggestions);
+
+    // Keys that end here have no child; the others are grouped by their
+    // next character.
+    std::size_t first{begin};
+    while ((first<end) && (keys[first].Text.size()==depth))
+    {
+      first++;
+    }
+    std::vector<std::pair<std::size_t,std::size_t>> groups{};
+    for (std::size_t k=first; k<end;)
+    {
+      std::size_t next{k+1};
+      while ((next<end) && (keys[next].Text[depth]==keys[k].Text[depth]))
+      {
+        next++;
+      }
+      groups.emplace_back(k,next);
+      k=next;
+    }
+
+    const auto first_child{static_cast<std::uint32_t>(nodes.size())};
+    nodes[node].First_child=first_child;
+    nodes[node].N_children=static_cast<std::uint16_t>(groups.size());
+    for (const auto& group : groups)
+    {
+      Node child{};
+      child.Label=keys[group.first].Text[depth];
+      nodes.push_back(child);
+    }
+    for (std::size_t g=0; g<groups.size(); g++)
+    {
+      build_node(shard,first_child+static_cast<std::uint32_t>(g),keys,
+                 groups[g].first,groups[g].second,depth+1);
+    }
+  } // End of build_node
+
+  //=========================================================================
+  //
+  //=========================================================================
+  StationMatch StationSearch::match(std::uint32_t slot,
+                                    unsigned distance) const
+  {
+    return {Slots[slot].Station_id,Slots[slot].Name,distance};
+  } // End of match
+} // namespace NetworkMonitor
@@ -0,0 +1,143 @@
+// Boost-specific libraries
+#include <boost/asio/ssl.hpp>
+#include <boost/system/error_code.hpp>
+
+// OpenSSL libraries to use SSL/TLS protocols
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+// Regular libraries
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// The matching header
+#include "network-monitor/tls_context.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // Parse a CA file into a certificate store, once per file and process.
+  // Returns nullptr if the file could not be loaded. The caller gets its own
+  // reference to the store.
+  //===========================================================================
+  static X509_STORE* shared_ca_store(const std::filesystem::path& ca_cert_file)
+  {
+    // Stores are kept for the lifetime of the process.
+    static std::mutex mutex{};
+    static std::map<std::string, X509_STORE*> stores{};
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto found{stores.find(ca_cert_file.string())};
+    if (found==stores.end())
+    {
+      // Let a throwaway context do the parsing, then keep its store.
+      boost::asio::ssl::context loader{boost::asio::ssl::context::tls_client};
+      boost::system::error_code ec{};
+      loader.load_verify_file(ca_cert_file.string(),ec);
+      if (ec)
+      {
+        return nullptr;
+      }
+      X509_STORE* store{SSL_CTX_get_cert_store(loader.native_handle())};
+      X509_STORE_up_ref(store);
+      found=stores.emplace(ca_cert_file.string(),store).first;
+    }
+    X509_STORE_up_ref(found->second);
+    return found->second;
+  } // End of shared_ca_store
+
+  // Public functions
+
+  //===========================================================================
+  /*! \brief Create a TLS client context that trusts the CAs of a cacert.pem
+             file.
+
+      The file is parsed the first time it is requested and the resulting
+      certificate store is shared, reference-counted, by every context made
+      from it afterwards, so that the 3,000+ line bundle is parsed once per
+      process rather than once per context. Contexts may be created from any
+      thread.
+
+      The contexts verify the peer certificate against the CAs, and fail
+      the TLS handshake if it does not chain to one of them. The host name
+      is not part of the context: the connection checks it, as
+      WebSocketClient does for its URL.
+
+      The certificate store is shared: do not add certificates to it through
+      one of the contexts.
+
+      \param ca_cert_file The path to a cacert.pem file.
+      \returns            nullptr if the CA file could not be loaded.
+  */
+  //===========================================================================
+  std::shared_ptr<boost::asio::ssl::context> make_tls_client_context(
+    const std::filesystem::path& ca_cert_file)
+  {
+    X509_STORE* store{shared_ca_store(ca_cert_file)};
+    if (store==nullptr)
+    {
+      return nullptr;
+    }
+
+    auto ctx{std::make_shared<boost::asio::ssl::context>(
+      boost::asio::ssl::context::tlsv12_client)};
+
+    // The context takes over the reference we got.
+    SSL_CTX_set_cert_store(ctx->native_handle(),store);
+    ctx->set_verify_mode(boost::asio::ssl::verify_peer);
+    return ctx;
+  } // End of make_tls_client_context
+
+  //===========================================================================
+  /*! \brief Create a TLS server context from a certificate chain and its
+             private key, both in PEM format.
+
+      \param cert_chain_file  The server certificate, followed by any
+                              intermediate certificates.
+      \param private_key_file The private key of the server certificate.
+      \returns                nullptr if either file could not be loaded.
+  */
+  //===========================================================================
+  std::shared_ptr<boost::asio::ssl::context> make_tls_server_context(
+    const std::filesystem::path& cert_chain_file,
+    const std::filesystem::path& private_key_file)
+  {
+    auto ctx{std::make_shared<boost::asio::ssl::context>(
+      boost::asio::ssl::context::tlsv12_server)};
+
+    boost::system::error_code ec{};
+    ctx->use_certificate_chain_file(cert_chain_file.string(),ec);
+    if (!ec)
+    {
+      ctx->use_private_key_file(private_key_file.string(),
+                                boost::asio::ssl::context::pem,ec);
+    }
+    if (ec)
+    {
+      return nullptr;
+    }
+    return ctx;
+  } // End of make_tls_server_context
+
+  //===========================================================================
+  /*! \brief Whether this build of OpenSSL can use kernel TLS.
+
+      kTLS only engages for TLS sessions that read and write a socket
+      directly. Boost.Asio's ssl::stream, and so WebSocketClient, runs TLS
+      through memory BIOs and cannot use it.
+  */
+  //===========================================================================
+  bool ktls_supported()
+  {
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+    return true;
+#else
+    return false;
+#endif
+  } // End of ktls_supported
+} // namespace NetworkMonitor
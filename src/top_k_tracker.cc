@@ -0,0 +1,211 @@
+// Regular libraries
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// The matching header
+#include "network-monitor/top_k_tracker.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // Whether a is more loaded than b; ties go to the lower ID.
+  //===========================================================================
+  static bool more_loaded(const TopKTracker::Entry& a,
+                          const TopKTracker::Entry& b)
+  {
+    return (a.load>b.load) || ((a.load==b.load) && (a.id<b.id));
+  } // End of more_loaded
+
+  //===========================================================================
+  // Whether a belongs above b in a heap: the least loaded item is the root of
+  // the top heap, and the most loaded one is the root of the other heap.
+  //===========================================================================
+  static bool above(bool top,
+                    const TopKTracker::Entry& a,
+                    const TopKTracker::Entry& b)
+  {
+    return top ? more_loaded(b,a) : more_loaded(a,b);
+  } // End of above
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct a tracker where every item has a load of zero.
+
+      \param n_items  The number of items.
+      \param k        The number of items to keep track of.
+  */
+  //=========================================================================
+  TopKTracker::TopKTracker(std::size_t n_items, std::size_t k) :
+    Positions(n_items,0)
+  {
+    // With equal loads, the lowest IDs are the top ones. Sorted arrays are
+    // valid heaps: the top heap holds its IDs in decreasing order, so that
+    // the root is the highest of them, and the other heap in increasing
+    // order.
+    k=std::min(k,n_items);
+    Top.reserve(k);
+    Rest.reserve(n_items-k);
+    for (std::size_t i=k; i>0; i--)
+    {
+      Top.push_back({static_cast<std::uint32_t>(i-1),0});
+    }
+    for (std::size_t i=k; i<n_items; i++)
+    {
+      Rest.push_back({static_cast<std::uint32_t>(i),0});
+    }
+    for (std::size_t p=0; p<Top.size(); p++)
+    {
+      Positions[Top[p].id]=static_cast<std::uint32_t>(p)|In_top;
+    }
+    for (std::size_t p=0; p<Rest.size(); p++)
+    {
+      Positions[Rest[p].id]=static_cast<std::uint32_t>(p);
+    }
+  } // End of TopKTracker
+
+  //=========================================================================
+  /*! \brief Set the load of an item.
+  */
+  //=========================================================================
+  void TopKTracker::set(std::uint32_t id, std::int64_t load)
+  {
+    update(id,load);
+  } // End of set
+
+  //=========================================================================
+  /*! \brief Add to (or, with a negative delta, subtract from) the load of
+             an item.
+  */
+  //=========================================================================
+  void TopKTracker::add(std::uint32_t id, std::int64_t delta)
+  {
+    update(id,load(id)+delta);
+  } // End of add
+
+  //=========================================================================
+  /*! \brief The current load of an item.
+  */
+  //=========================================================================
+  std::int64_t TopKTracker::load(std::uint32_t id) const
+  {
+    const std::uint32_t position{Positions[id]};
+    return (position&In_top) ? Top[position&~In_top].load :
+                               Rest[position].load;
+  } // End of load
+
+  //=========================================================================
+  /*! \brief The K most loaded items, in no particular order.
+
+      \note The reference is invalidated by the next update.
+  */
+  //=========================================================================
+  const std::vector<TopKTracker::Entry>& TopKTracker::top() const
+  {
+    return Top;
+  } // End of top
+
+  //=========================================================================
+  /*! \brief The K most loaded items, most loaded first.
+  */
+  //=========================================================================
+  std::vector<TopKTracker::Entry> TopKTracker::sorted_top() const
+  {
+    std::vector<Entry> sorted{Top};
+    std::sort(sorted.begin(),sorted.end(),more_loaded);
+    return sorted;
+  } // End of sorted_top
+
+  // Private methods
+
+  //=========================================================================
+  //
+  //=========================================================================
+  std::vector<TopKTracker::Entry>& TopKTracker::heap(bool top)
+  {
+    return top ? Top : Rest;
+  } // End of heap
+
+  //=========================================================================
+  // Record where the entry at a heap position lives
+  //=========================================================================
+  void TopKTracker::place(bool top, std::size_t position)
+  {
+    Positions[heap(top)[position].id]=
+      static_cast<std::uint32_t>(position)|(top ? In_top : 0);
+  } // End of place
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void TopKTracker::sift_up(bool top, std::size_t position)
+  {
+    auto& entries{heap(top)};
+    while (position>0)
+    {
+      const std::size_t parent{(position-1)/2};
+      if (!above(top,entries[position],entries[parent]))
+      {
+        break;
+      }
+      std::swap(entries[position],entries[parent]);
+      place(top,position);
+      position=parent;
+    }
+    place(top,position);
+  } // End of sift_up
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void TopKTracker::sift_down(bool top, std::size_t position)
+  {
+    auto& entries{heap(top)};
+    while (true)
+    {
+      std::size_t best{position};
+      for (std::size_t child=2*position+1;
+           (child<=2*position+2) && (child<entries.size()); child++)
+      {
+        if (above(top,entries[child],entries[best]))
+        {
+          best=child;
+        }
+      }
+      if (best==position)
+      {
+        break;
+      }
+      std::swap(entries[position],entries[best]);
+      place(top,position);
+      position=best;
+    }
+    place(top,position);
+  } // End of sift_down
+
+  //=========================================================================
+  // Restore both heaps after one load change. At most one item has to cross
+  // between them: the root of one heap swaps with the root of the other.
+  //=========================================================================
+  void TopKTracker::update(std::uint32_t id, std::int64_t load)
+  {
+    const std::uint32_t position{Positions[id]};
+    const bool top{(position&In_top)!=0};
+    const std::size_t index{position&~In_top};
+    heap(top)[index].load=load;
+    sift_up(top,index);
+    sift_down(top,Positions[id]&~In_top);
+
+    if (Top.empty() || Rest.empty() || !more_loaded(Rest[0],Top[0]))
+    {
+      return;
+    }
+    std::swap(Top[0],Rest[0]);
+    sift_down(true,0);
+    sift_down(false,0);
+  } // End of update
+} // namespace NetworkMonitor
@@ -0,0 +1,400 @@
+// POSIX memory mapping
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// The matching header
+#include "network-monitor/travel_time_matrix.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  /*! \brief Header of a saved matrix; the tiles follow it.
+  */
+  //===========================================================================
+  struct TravelTimeMatrixFileHeader
+  {
+    char Magic[8];
+    std::uint32_t N_stations;
+    std::uint32_t Block_size;
+    std::uint64_t Fingerprint;
+  };
+
+  static constexpr char Matrix_file_magic[8]{'N','M','T','T','M','X','0','1'};
+
+  //===========================================================================
+  // FNV-1a hash of the station IDs in dense ID order, to detect a matrix
+  // built for another layout
+  //===========================================================================
+  static std::uint64_t fingerprint(const StationIndex& stations)
+  {
+    std::uint64_t hash{0xcbf29ce484222325ULL};
+    for (std::uint32_t i=0; i<stations.size(); i++)
+    {
+      // Include the terminating NULL so that the IDs cannot run together.
+      const std::string& station_id{stations.station_id(i)};
+      for (std::size_t c=0; c<=station_id.size(); c++)
+      {
+        hash^=static_cast<unsigned char>(station_id.c_str()[c]);
+        hash*=0x100000001b3ULL;
+      }
+    }
+    return hash;
+  } // End of fingerprint
+
+  //===========================================================================
+  /*! \brief Adjacency lists of the network in compressed sparse row form.
+  */
+  //===========================================================================
+  struct TravelTimeGraph
+  {
+    std::vector<std::size_t> Offsets{};
+    std::vector<std::uint32_t> Targets{};
+    std::vector<std::uint32_t> Weights{};
+  };
+
+  //===========================================================================
+  // Build the graph: one edge per pair of consecutive route stops, weighted
+  // by the shortest travel time listed for that pair in either direction
+  //===========================================================================
+  static TravelTimeGraph make_graph(const nlohmann::json& network_layout,
+                                    const StationIndex& stations)
+  {
+    std::map<std::pair<std::uint32_t,std::uint32_t>,std::uint32_t> times{};
+    if (network_layout.contains("travel_times"))
+    {
+      for (const auto& travel_time : network_layout.at("travel_times"))
+      {
+        const std::uint32_t a{stations.find(
+          travel_time.at("start_station_id").get<std::string>())};
+        const std::uint32_t b{stations.find(
+          travel_time.at("end_station_id").get<std::string>())};
+        if ((a==StationIndex::npos) || (b==StationIndex::npos))
+        {
+          continue;
+        }
+        const auto minutes{travel_time.at("travel_time").get<std::uint32_t>()};
+        auto key{std::minmax(a,b)};
+        auto found{times.find(key)};
+        if ((found==times.end()) || (minutes<found->second))
+        {
+          times[key]=minutes;
+        }
+      }
+    }
+
+    // Directed edges along the routes, deduplicated
+    std::map<std::pair<std::uint32_t,std::uint32_t>,std::uint32_t> edges{};
+    if (network_layout.contains("lines"))
+    {
+      for (const auto& line : network_layout.at("lines"))
+      {
+        for (const auto& route : line.value("routes",nlohmann::json::array()))
+        {
+          const auto& stops{route.at("route_stops")};
+          for (std::size_t i=1; i<stops.size(); i++)
+          {
+            const std::uint32_t a{stations.find(
+              stops[i-1].get<std::string>())};
+            const std::uint32_t b{stations.find(stops[i].get<std::string>())};
+            const auto time{times.find(std::minmax(a,b))};
+            if ((a==StationIndex::npos) || (b==StationIndex::npos) ||
+                (time==times.end()))
+            {
+              continue;
+            }
+            edges[{a,b}]=time->second;
+          }
+        }
+      }
+    }
+
+    TravelTimeGraph graph{};
+    graph.Offsets.assign(stations.size()+1,0);
+    for (const auto& edge : edges)
+    {
+      graph.Offsets[edge.first.first+1]++;
+      graph.Targets.push_back(edge.first.second);
+      graph.Weights.push_back(edge.second);
+    }
+    for (std::size_t i=1; i<graph.Offsets.size(); i++)
+    {
+      graph.Offsets[i]+=graph.Offsets[i-1];
+    }
+    return graph;
+  } // End of make_graph
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Compute the matrix of a network.
+
+      \param network_layout The parsed network-layout.json file.
+      \param stations       The dense station IDs of the network; they
+                            index the rows and columns of the matrix.
+      \param n_threads      The number of threads to use; 0 uses one per
+                            hardware thread.
+  */
+  //=========================================================================
+  TravelTimeMatrix::TravelTimeMatrix(const nlohmann::json& network_layout,
+                                     const StationIndex& stations,
+                                     unsigned n_threads)
+  {
+    resize(stations.size());
+    if (N_stations==0)
+    {
+      return;
+    }
+    const TravelTimeGraph graph{make_graph(network_layout,stations)};
+
+    // Sources are handed out one at a time, so a thread that finishes early
+    // simply takes the next one.
+    std::atomic<std::size_t> next_source{0};
+    auto worker{[this,&graph,&next_source]()
+    {
+      using Entry=std::pair<std::uint32_t,std::uint32_t>;
+      std::vector<std::uint32_t> distances(N_stations);
+      std::priority_queue<Entry,std::vector<Entry>,std::greater<Entry>> queue{};
+      for (std::size_t source=next_source++; source<N_stations;
+           source=next_source++)
+      {
+        // Dijkstra's algorithm from this source
+        std::fill(distances.begin(),distances.end(),0xFFFFFFFF);
+        distances[source]=0;
+        queue.push({0,static_cast<std::uint32_t>(source)});
+        while (!queue.empty())
+        {
+          const auto [distance,station]{queue.top()};
+          queue.pop();
+          if (distance>distances[station])
+          {
+            continue;
+          }
+          for (std::size_t e=graph.Offsets[station];
+               e<graph.Offsets[station+1]; e++)
+          {
+            const std::uint32_t candidate{distance+graph.Weights[e]};
+            if (candidate<distances[graph.Targets[e]])
+            {
+              distances[graph.Targets[e]]=candidate;
+              queue.push({candidate,graph.Targets[e]});
+            }
+          }
+        }
+
+        // Each source owns its row, so threads never write the same cells.
+        for (std::size_t to=0; to<N_stations; to++)
+        {
+          Data[cell(source,to)]=static_cast<std::uint16_t>(
+            std::min<std::uint32_t>(distances[to],unreachable));
+        }
+      }
+    }};
+
+    if (n_threads==0)
+    {
+      n_threads=std::max(1u,std::thread::hardware_concurrency());
+    }
+    std::vector<std::thread> threads{};
+    for (unsigned i=1; i<n_threads; i++)
+    {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+  } // End of TravelTimeMatrix
+
+  //=========================================================================
+  /*! \brief Move constructor
+  */
+  //=========================================================================
+  TravelTimeMatrix::TravelTimeMatrix(TravelTimeMatrix&& other) noexcept
+  {
+    *this=std::move(other);
+  } // End of TravelTimeMatrix
+
+  //=========================================================================
+  /*! \brief Move assignment
+  */
+  //=========================================================================
+  TravelTimeMatrix& TravelTimeMatrix::operator=(
+    TravelTimeMatrix&& other) noexcept
+  {
+    if (this!=&other)
+    {
+      if (Mapping!=nullptr)
+      {
+        munmap(Mapping,Mapping_size);
+      }
+      N_stations=std::exchange(other.N_stations,0);
+      N_blocks=std::exchange(other.N_blocks,0);
+      Data=std::move(other.Data);
+      Cells=std::exchange(other.Cells,nullptr);
+      Mapping=std::exchange(other.Mapping,nullptr);
+      Mapping_size=std::exchange(other.Mapping_size,0);
+
+      // A moved vector keeps its buffer, so owned cells stay valid.
+      other.Data.clear();
+    }
+    return *this;
+  } // End of operator=
+
+  //=========================================================================
+  /*! \brief Destructor; unmaps the file the matrix was loaded from, if
+             any.
+  */
+  //=========================================================================
+  TravelTimeMatrix::~TravelTimeMatrix()
+  {
+    if (Mapping!=nullptr)
+    {
+      munmap(Mapping,Mapping_size);
+    }
+  } // End of ~TravelTimeMatrix
+
+  //=========================================================================
+  /*! \brief The number of stations, i.e. rows and columns, in the matrix.
+  */
+  //=========================================================================
+  std::size_t TravelTimeMatrix::size() const
+  {
+    return N_stations;
+  } // End of size
+
+  //=========================================================================
+  /*! \brief Save the matrix to a file.
+
+      \param destination  The full path and filename of the output file.
+                          The path to the file must exist.
+      \param stations     The station index the matrix was built with. A
+                          fingerprint of it is stored in the file.
+  */
+  //=========================================================================
+  bool TravelTimeMatrix::save(const std::filesystem::path& destination,
+                              const StationIndex& stations) const
+  {
+    if (stations.size()!=N_stations)
+    {
+      return false;
+    }
+
+    std::ofstream file{destination,std::ios::binary|std::ios::trunc};
+    if (!file)
+    {
+      return false;
+    }
+
+    TravelTimeMatrixFileHeader header{};
+    std::memcpy(header.Magic,Matrix_file_magic,sizeof(header.Magic));
+    header.N_stations=static_cast<std::uint32_t>(N_stations);
+    header.Block_size=static_cast<std::uint32_t>(block_size);
+    header.Fingerprint=fingerprint(stations);
+    file.write(reinterpret_cast<const char*>(&header),sizeof(header));
+    file.write(reinterpret_cast<const char*>(Cells),
+               static_cast<std::streamsize>(
+                 N_blocks*N_blocks*block_size*block_size*sizeof(*Cells)));
+    return static_cast<bool>(file);
+  } // End of save
+
+  //=========================================================================
+  /*! \brief Memory-map a matrix saved with save().
+
+      \param source   The path to the file to load.
+      \param stations The station index to use the matrix with. It must
+                      list the same stations, in the same order, as the
+                      one the matrix was built with.
+      \returns        An empty matrix if the file cannot be mapped, is
+                      malformed, or was built for other stations.
+  */
+  //=========================================================================
+  TravelTimeMatrix TravelTimeMatrix::load(const std::filesystem::path& source,
+                                          const StationIndex& stations)
+  {
+    TravelTimeMatrix matrix{};
+
+    const int fd{open(source.c_str(),O_RDONLY)};
+    if (fd<0)
+    {
+      return matrix;
+    }
+    struct stat file_status{};
+    if ((fstat(fd,&file_status)!=0) ||
+        (static_cast<std::size_t>(file_status.st_size)<
+         sizeof(TravelTimeMatrixFileHeader)))
+    {
+      close(fd);
+      return matrix;
+    }
+    const std::size_t file_size{static_cast<std::size_t>(file_status.st_size)};
+    void* mapping{mmap(nullptr,file_size,PROT_READ,MAP_PRIVATE,fd,0)};
+
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    if (mapping==MAP_FAILED)
+    {
+      return matrix;
+    }
+
+    TravelTimeMatrixFileHeader header{};
+    std::memcpy(&header,mapping,sizeof(header));
+    const std::size_t n_blocks{(stations.size()+block_size-1)/block_size};
+    const std::size_t expected_size{
+      sizeof(header)+
+      n_blocks*n_blocks*block_size*block_size*sizeof(std::uint16_t)};
+    if ((std::memcmp(header.Magic,Matrix_file_magic,sizeof(header.Magic))!=0) ||
+        (header.Block_size!=block_size) ||
+        (header.N_stations!=stations.size()) ||
+        (header.Fingerprint!=fingerprint(stations)) ||
+        (file_size!=expected_size))
+    {
+      munmap(mapping,file_size);
+      return matrix;
+    }
+
+    // Serve the cells straight from the mapping.
+    matrix.N_stations=stations.size();
+    matrix.N_blocks=n_blocks;
+    matrix.Mapping=mapping;
+    matrix.Mapping_size=file_size;
+    matrix.Cells=reinterpret_cast<const std::uint16_t*>(
+      static_cast<const char*>(mapping)+sizeof(header));
+    return matrix;
+  } // End of load
+
+  // Private methods
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void TravelTimeMatrix::resize(std::size_t n_stations)
+  {
+    N_stations=n_stations;
+    N_blocks=(n_stations+block_size-1)/block_size;
+    Data.assign(N_blocks*N_blocks*block_size*block_size,unreachable);
+    Cells=Data.data();
+  } // End of resize
+} // namespace NetworkMonitor
@@ -1,5 +1,6 @@
 // Boost-specific libraries
 #include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
 #include <boost/beast.hpp>
 #include <boost/system/error_code.hpp>
 
@@ -45,7 +46,9 @@ namespace NetworkMonitor
       \param port     The port on the server.
       \param ioc      The io_context object. The user takes care of calling
                       ioc.run().
-      \param ctx      The TLS context to setup a TLS socket stream.
+      \param ctx      The TLS context to setup a TLS socket stream. If it
+                      verifies the peer, the server certificate must
+                      also be valid for url.
   */
   //=========================================================================
   WebSocketClient::WebSocketClient(const std::string& url,
@@ -57,7 +60,8 @@ namespace NetworkMonitor
     Endpoint(endpoint),
     Port(port),
     Resolver(boost::asio::make_strand(ioc)),
-    Web_socket(boost::asio::make_strand(ioc),ctx)
+    Web_socket(boost::asio::make_strand(ioc),ctx),
+    Ping_timer(Web_socket.get_executor())
   {} // End of WebSocketClient
 
   //=========================================================================
@@ -130,6 +134,7 @@ namespace NetworkMonitor
   void WebSocketClient::close(
     std::function<void (boost::system::error_code)> on_close)
   {
+    stop_ping();
     Web_socket.async_close(
       boost::beast::websocket::close_code::none,
       [this,on_close](auto err_code)
@@ -141,6 +146,77 @@ namespace NetworkMonitor
     });
   } // End of close
 
+  //=========================================================================
+  /*! \brief Measure the round-trip time of the connection with WebSocket
+             ping/pong frames.
+
+      One ping is sent per interval, starting as soon as the connection is
+      open. A ping still unanswered when the next one is due counts as a
+      missed pong.
+      If the previous ping has not even been written yet, no new ping is
+      sent and that tick also counts as a missed pong.
+
+      \param interval The time between two pings.
+      \param on_rtt   Called with the round-trip time of every pong.
+  */
+  //=========================================================================
+  void WebSocketClient::start_ping(
+    std::chrono::milliseconds interval,
+    std::function<void (std::chrono::microseconds)> on_rtt)
+  {
+    boost::asio::post(
+      Web_socket.get_executor(),
+      [this,interval,on_rtt]()
+    {
+      OnRttPt=on_rtt;
+      Ping_interval=interval;
+
+      // If we are not connected yet, on_handshake starts the pings.
+      if (Web_socket.is_open())
+      {
+        Ping_timer.cancel();
+        send_ping({});
+      }
+    });
+  } // End of start_ping
+
+  //=========================================================================
+  /*! \brief Stop sending pings.
+  */
+  //=========================================================================
+  void WebSocketClient::stop_ping()
+  {
+    boost::asio::post(
+      Web_socket.get_executor(),
+      [this]()
+    {
+      Ping_interval=std::chrono::milliseconds(0);
+      Ping_timer.cancel();
+    });
+  } // End of stop_ping
+
+  //=========================================================================
+  /*! \brief The round-trip times of the most recent pongs.
+
+      \note Only read this from the io_context thread, e.g. in a callback.
+  */
+  //=========================================================================
+  const RttHistogram& WebSocketClient::rtt_histogram() const
+  {
+    return Rtt;
+  } // End of rtt_histogram
+
+  //=========================================================================
+  /*! \brief The number of pings in a row that did not get a pong.
+
+      \note Only read this from the io_context thread, e.g. in a callback.
+  */
+  //=========================================================================
+  std::size_t WebSocketClient::missed_pongs() const
+  {
+    return Missed_pongs;
+  } // End of missed_pongs
+
   // Private methods
 
   //=========================================================================
@@ -200,7 +276,14 @@ namespace NetworkMonitor
       boost::beast::websocket::stream_base::timeout::suggested(
         boost::beast::role_type::client));
 
-    // Attempt a WebSocket handshake.
+    // The server certificate must be valid for the host we asked for. Send
+    // the host name too (SNI), for servers that host several of them.
+    SSL_set_tlsext_host_name(Web_socket.next_layer().native_handle(),
+                             Url.c_str());
+    Web_socket.next_layer().set_verify_callback(
+      boost::asio::ssl::host_name_verification(Url));
+
+    // Attempt a TLS handshake.
     Web_socket.next_layer().async_handshake(
       boost::asio::ssl::stream_base::client,
       [this](auto err_code)
@@ -216,6 +299,17 @@ namespace NetworkMonitor
   void WebSocketClient::on_tls_handshake(
     const boost::system::error_code& err_code)
   {
+    // An untrusted certificate, or one for another host, ends here.
+    if (err_code)
+    {
+      log("on_tls_handshake",err_code);
+      if (OnConnectPt)
+      {
+        OnConnectPt(err_code);
+      }
+      return;
+    }
+
     // Attempt a WebSocket handshake.
     Web_socket.async_handshake(
       Url,Endpoint,
@@ -244,6 +338,17 @@ namespace NetworkMonitor
     // Tell the WebSocket object to exchange messages in text format.
     Web_socket.text(true);
 
+    // Pongs arrive as control frames while we wait for messages.
+    Web_socket.control_callback(
+      [this](auto kind, auto payload)
+    {
+      on_control_frame(kind,payload);
+    });
+    if (Ping_interval.count()>0)
+    {
+      send_ping({});
+    }
+
     // Now that we are connected, set up a recursive asynchronous listener to
     // receive messages.
     listen_to_incoming_message(err_code);
@@ -307,6 +412,85 @@ namespace NetworkMonitor
   } // End of on_read
 
 
+  //=========================================================================
+  //
+  //=========================================================================
+  void WebSocketClient::send_ping(const boost::system::error_code& err_code)
+  {
+    // The timer was cancelled, pings were stopped, or we are disconnected.
+    if ((err_code==boost::asio::error::operation_aborted) ||
+        (Ping_interval.count()==0) || !Web_socket.is_open())
+    {
+      return;
+    }
+
+    if (Ping_in_flight)
+    {
+      // Beast does not allow two pings at once: the previous one is still
+      // queued behind a stalled write, so skip this one and count it as lost.
+      Missed_pongs++;
+    }
+    else
+    {
+      if (Pong_pending)
+      {
+        Missed_pongs++;
+      }
+
+      // The payload identifies the ping, so that a late pong is not matched
+      // with a newer ping.
+      Ping_sequence++;
+      Pong_pending=true;
+      Ping_in_flight=true;
+      Ping_sent_at=std::chrono::steady_clock::now();
+      const std::string sequence{std::to_string(Ping_sequence)};
+      Web_socket.async_ping(
+        boost::beast::websocket::ping_data{sequence.data(),sequence.size()},
+        [this](auto err_code)
+      {
+        // A failed ping shows up as a missed pong.
+        Ping_in_flight=false;
+        if (err_code && (err_code!=boost::asio::error::operation_aborted))
+        {
+          log("send_ping",err_code);
+        }
+      });
+    }
+
+    Ping_timer.expires_after(Ping_interval);
+    Ping_timer.async_wait(
+      [this](auto err_code)
+    {
+      send_ping(err_code);
+    });
+  } // End of send_ping
+
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void WebSocketClient::on_control_frame(
+    boost::beast::websocket::frame_type kind,
+    boost::beast::string_view payload)
+  {
+    if ((kind!=boost::beast::websocket::frame_type::pong) || !Pong_pending ||
+        (payload!=std::to_string(Ping_sequence)))
+    {
+      return;
+    }
+
+    const auto rtt{std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now()-Ping_sent_at)};
+    Pong_pending=false;
+    Missed_pongs=0;
+    Rtt.record(rtt);
+    if (OnRttPt)
+    {
+      OnRttPt(rtt);
+    }
+  } // End of on_control_frame
+
+
 
 
 
@@ -0,0 +1,628 @@
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/system/error_code.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Headers we've defined
+#include "network-monitor/websocket_server.h"
+
+namespace NetworkMonitor
+{
+  // Static functions
+
+  //===========================================================================
+  // General logging function
+  //===========================================================================
+  static void log(const std::string& where,
+                  const boost::system::error_code& ec)
+  {
+    std::cerr << "[" << std::setw(20) << where << "] "
+              << (ec ? "Error: " : "OK")
+              << (ec ? ec.message() : "")
+              << std::endl;
+  } // End of log
+
+  //===========================================================================
+  /*! \brief State shared between the server and its sessions.
+  */
+  //===========================================================================
+  struct WebSocketSubscribers
+  {
+    std::size_t Max_queue_size{0};
+    WebSocketServer::SlowClientPolicy Policy{
+      WebSocketServer::SlowClientPolicy::Disconnect};
+
+    std::function<void (boost::system::error_code)> OnSubscribePt{nullptr};
+    std::function<void (boost::system::error_code)> OnUnsubscribePt{nullptr};
+    std::function<bool (const std::string&,std::string&)> OnRequestPt{nullptr};
+
+    // The connected sessions, and those of them that are subscribers; the
+    // maps keep them alive until they leave.
+    mutable std::mutex Mutex{};
+    std::unordered_map<WebSocketSession*,
+                       std::shared_ptr<WebSocketSession>> Sessions{};
+    std::unordered_map<WebSocketSession*,
+                       std::shared_ptr<WebSocketSession>> Subscribers{};
+
+    std::atomic<std::size_t> Dropped_messages{0};
+
+    // Messages handed to a session and not yet written, dropped or
+    // discarded
+    std::atomic<std::size_t> Pending_messages{0};
+  };
+
+  //===========================================================================
+  /*! \brief One subscriber connection, as seen by the server.
+  */
+  //===========================================================================
+  class WebSocketSession
+  {
+  public:
+    virtual ~WebSocketSession() = default;
+
+    // Perform the TLS and WebSocket handshakes
+    virtual void start() = 0;
+
+    // Queue a message
+    virtual void send(const std::shared_ptr<const std::string>& message) = 0;
+
+    // Drop the connection
+    virtual void close() = 0;
+  };
+
+  //===========================================================================
+  /*! \brief One subscriber connection, over plain TCP or over TLS.
+
+      All the members run on the session strand. Other threads only reach
+      the session through send() and close(), which post to it.
+  */
+  //===========================================================================
+  template <bool Tls>
+  class BasicWebSocketSession :
+    public WebSocketSession,
+    public std::enable_shared_from_this<BasicWebSocketSession<Tls>>
+  {
+  public:
+    using Stream = std::conditional_t<
+      Tls,
+      boost::beast::websocket::stream<
+        boost::beast::ssl_stream<boost::beast::tcp_stream>>,
+      boost::beast::websocket::stream<boost::beast::tcp_stream>>;
+
+    template <typename... Args>
+    BasicWebSocketSession(std::shared_ptr<WebSocketSubscribers> subscribers,
+                          Args&&... stream_args) :
+      Web_socket(std::forward<Args>(stream_args)...),
+      Subscribers_pt(std::move(subscribers))
+    {}
+
+    void start() override
+    {
+      if constexpr (Tls)
+      {
+        // The WebSocket timeouts only start with the WebSocket handshake.
+        boost::beast::get_lowest_layer(Web_socket).expires_after(
+          std::chrono::seconds(30));
+        Web_socket.next_layer().async_handshake(
+          boost::asio::ssl::stream_base::server,
+          [self=this->shared_from_this()](auto ec)
+        {
+          if (ec)
+          {
+            self->on_accept(ec);
+            return;
+          }
+          boost::beast::get_lowest_layer(self->Web_socket).expires_never();
+          self->accept();
+        });
+      }
+      else
+      {
+        accept();
+      }
+    }
+
+    void send(const std::shared_ptr<const std::string>& message) override
+    {
+      boost::asio::post(
+        Web_socket.get_executor(),
+        [self=this->shared_from_this(),message]()
+      {
+        self->enqueue(message);
+      });
+    }
+
+    void close() override
+    {
+      boost::asio::post(
+        Web_socket.get_executor(),
+        [self=this->shared_from_this()]()
+      {
+        self->disconnect();
+      });
+    }
+
+  private:
+    Stream Web_socket;
+    boost::beast::flat_buffer Read_buffer{};
+    std::shared_ptr<WebSocketSubscribers> Subscribers_pt;
+
+    // Messages waiting to be sent; while Writing, the front one is being
+    // written and must outlive the write.
+    std::deque<std::shared_ptr<const std::string>> Queue{};
+    bool Writing{false};
+    bool Connected{false};
+    bool Registered{false};
+    bool Closed{false};
+
+    // Perform the WebSocket handshake
+    void accept()
+    {
+      Web_socket.set_option(
+        boost::beast::websocket::stream_base::timeout::suggested(
+          boost::beast::role_type::server));
+      Web_socket.async_accept(
+        [self=this->shared_from_this()](auto ec)
+      {
+        self->on_accept(ec);
+      });
+    }
+
+    void on_accept(const boost::system::error_code& ec)
+    {
+      if (ec)
+      {
+        log("on_accept",ec);
+        if (Subscribers_pt->OnSubscribePt)
+        {
+          Subscribers_pt->OnSubscribePt(ec);
+        }
+        return;
+      }
+
+      Web_socket.text(true);
+      {
+        std::lock_guard<std::mutex> lock{Subscribers_pt->Mutex};
+        Subscribers_pt->Sessions.emplace(this,this->shared_from_this());
+      }
+      Connected=true;
+      listen_to_incoming_message();
+
+      // Without a request handler, every client is a subscriber.
+      if (!Subscribers_pt->OnRequestPt)
+      {
+        subscribe();
+      }
+    }
+
+    void subscribe()
+    {
+      {
+        std::lock_guard<std::mutex> lock{Subscribers_pt->Mutex};
+        Subscribers_pt->Subscribers.emplace(this,this->shared_from_this());
+      }
+      Registered=true;
+
+      // Note: This call is synchronous and will block the session strand.
+      if (Subscribers_pt->OnSubscribePt)
+      {
+        Subscribers_pt->OnSubscribePt({});
+      }
+    }
+
+    void listen_to_incoming_message()
+    {
+      Web_socket.async_read(
+        Read_buffer,
+        [self=this->shared_from_this()](auto ec, auto n_bytes)
+      {
+        if (ec)
+        {
+          self->on_disconnect(ec);
+          return;
+        }
+        if (!self->Registered && self->Subscribers_pt->OnRequestPt)
+        {
+          self->on_request();
+        }
+        self->Read_buffer.consume(n_bytes);
+        self->listen_to_incoming_message();
+      });
+    }
+
+    void on_request()
+    {
+      const std::string request{
+        boost::beast::buffers_to_string(Read_buffer.data())};
+      std::string reply{};
+      const bool subscribed{Subscribers_pt->OnRequestPt(request,reply)};
+
+      // The reply is queued before any broadcast reaches this session.
+      if (!reply.empty())
+      {
+        Subscribers_pt->Pending_messages++;
+        enqueue(std::make_shared<const std::string>(std::move(reply)));
+      }
+      if (subscribed && !Closed)
+      {
+        subscribe();
+      }
+    }
+
+    // The caller has counted the message as pending.
+    void enqueue(const std::shared_ptr<const std::string>& message)
+    {
+      if (Closed)
+      {
+        Subscribers_pt->Pending_messages--;
+        return;
+      }
+
+      if (Queue.size()>=Subscribers_pt->Max_queue_size)
+      {
+        Subscribers_pt->Dropped_messages++;
+        Subscribers_pt->Pending_messages--;
+        if (Subscribers_pt->Policy==
+            WebSocketServer::SlowClientPolicy::Disconnect)
+        {
+          disconnect();
+        }
+        return;
+      }
+
+      Queue.push_back(message);
+      if (!Writing)
+      {
+        write_next();
+      }
+    }
+
+    void write_next()
+    {
+      // The shared buffer is written as is; the queue keeps it alive until
+      // the write completes.
+      Writing=true;
+      Web_socket.async_write(
+        boost::asio::buffer(*Queue.front()),
+        [self=this->shared_from_this()](auto ec, auto)
+      {
+        self->on_write(ec);
+      });
+    }
+
+    void on_write(const boost::system::error_code& ec)
+    {
+      Writing=false;
+      if (ec || Closed)
+      {
+        // The read loop reports the disconnection.
+        clear_queue();
+        return;
+      }
+
+      if (!Queue.empty())
+      {
+        Queue.pop_front();
+        Subscribers_pt->Pending_messages--;
+      }
+      if (!Queue.empty())
+      {
+        write_next();
+      }
+    }
+
+    // Discard the queued messages, except the one being written: its write
+    // handler discards it.
+    void clear_queue()
+    {
+      const std::size_t n_kept{(Writing && !Queue.empty()) ? 1u : 0u};
+      Subscribers_pt->Pending_messages-=Queue.size()-n_kept;
+      Queue.erase(Queue.begin()+n_kept,Queue.end());
+    }
+
+    // Abort the connection; the pending read fails and unregisters us.
+    void disconnect()
+    {
+      if (Closed)
+      {
+        return;
+      }
+      Closed=true;
+      boost::system::error_code ignored{};
+      boost::beast::get_lowest_layer(Web_socket).socket().shutdown(
+        boost::asio::ip::tcp::socket::shutdown_both,ignored);
+      boost::beast::get_lowest_layer(Web_socket).close();
+    }
+
+    void on_disconnect(const boost::system::error_code& ec)
+    {
+      Closed=true;
+      clear_queue();
+      if (!Connected)
+      {
+        return;
+      }
+      Connected=false;
+
+      // Keep ourselves alive until the end of this function.
+      auto self{this->shared_from_this()};
+      {
+        std::lock_guard<std::mutex> lock{Subscribers_pt->Mutex};
+        Subscribers_pt->Sessions.erase(this);
+        Subscribers_pt->Subscribers.erase(this);
+      }
+      if (!Registered)
+      {
+        return;
+      }
+      Registered=false;
+      if (Subscribers_pt->OnUnsubscribePt)
+      {
+        Subscribers_pt->OnUnsubscribePt(ec);
+      }
+    }
+  };
+
+  // Public methods
+
+  //=========================================================================
+  /*! \brief Construct a WebSocket server.
+
+      \note This constructor does not start listening for connections.
+
+      \param ip             The IP address to listen on.
+      \param port           The port to listen on; 0 picks a free port.
+      \param ioc            The io_context object. The user takes care of
+                            calling ioc.run(), from one or more threads.
+      \param max_queue_size The maximum number of messages queued for one
+                            subscriber, including the one being sent.
+      \param policy         What to do when a subscriber queue is full.
+  */
+  //=========================================================================
+  WebSocketServer::WebSocketServer(const std::string& ip,
+                                   unsigned short port,
+                                   boost::asio::io_context& ioc,
+                                   std::size_t max_queue_size,
+                                   SlowClientPolicy policy) :
+    Endpoint(boost::asio::ip::make_address(ip),port),
+    Ioc(ioc),
+    Acceptor(boost::asio::make_strand(ioc)),
+    Subscribers_pt(std::make_shared<WebSocketSubscribers>())
+  {
+    Subscribers_pt->Max_queue_size=std::max<std::size_t>(max_queue_size,1);
+    Subscribers_pt->Policy=policy;
+  } // End of WebSocketServer
+
+  //=========================================================================
+  /*! \brief Construct a WebSocket server over TLS.
+
+      \note This constructor does not start listening for connections.
+
+      \param ip             The IP address to listen on.
+      \param port           The port to listen on; 0 picks a free port.
+      \param ioc            The io_context object. The user takes care of
+                            calling ioc.run(), from one or more threads.
+      \param ctx            The TLS server context, with the certificate
+                            of the server. It must outlive the server.
+      \param max_queue_size The maximum number of messages queued for one
+                            subscriber, including the one being sent.
+      \param policy         What to do when a subscriber queue is full.
+  */
+  //=========================================================================
+  WebSocketServer::WebSocketServer(const std::string& ip,
+                                   unsigned short port,
+                                   boost::asio::io_context& ioc,
+                                   boost::asio::ssl::context& ctx,
+                                   std::size_t max_queue_size,
+                                   SlowClientPolicy policy) :
+    WebSocketServer(ip,port,ioc,max_queue_size,policy)
+  {
+    Ctx=&ctx;
+  } // End of WebSocketServer
+
+  //=========================================================================
+  /*! \brief Destructor
+  */
+  //=========================================================================
+  WebSocketServer::~WebSocketServer() = default;
+
+  //=========================================================================
+  /*! \brief Start accepting subscribers.
+
+      \param on_subscribe   Called when a client fails its handshake, or
+                            becomes a subscriber.
+      \param on_unsubscribe Called when a subscriber disconnects or is
+                            disconnected.
+      \param on_request     Called with every message a client sends
+                            before it is a subscriber. A non-empty reply
+                            is sent back to that client only. Return true
+                            to make the client a subscriber. It may run on
+                            several threads at once.
+      \returns              An error if the server could not listen on the
+                            requested address.
+  */
+  //=========================================================================
+  boost::system::error_code WebSocketServer::run(
+    std::function<void (boost::system::error_code)> on_subscribe,
+    std::function<void (boost::system::error_code)> on_unsubscribe,
+    std::function<bool (const std::string& request,
+                        std::string& reply)> on_request)
+  {
+    // Save the callbacks for later use
+    Subscribers_pt->OnSubscribePt=on_subscribe;
+    Subscribers_pt->OnUnsubscribePt=on_unsubscribe;
+    Subscribers_pt->OnRequestPt=on_request;
+
+    boost::system::error_code ec{};
+    Acceptor.open(Endpoint.protocol(),ec);
+    if (!ec)
+    {
+      Acceptor.set_option(boost::asio::socket_base::reuse_address(true),ec);
+    }
+    if (!ec)
+    {
+      Acceptor.bind(Endpoint,ec);
+    }
+    if (!ec)
+    {
+      Acceptor.listen(boost::asio::socket_base::max_listen_connections,ec);
+    }
+    if (ec)
+    {
+      log("run",ec);
+      return ec;
+    }
+
+    // Start the chain of asynchronous callbacks
+    listen_to_incoming_connection();
+    return ec;
+  } // End of run
+
+  //=========================================================================
+  /*! \brief Stop accepting subscribers and disconnect the current ones.
+  */
+  //=========================================================================
+  void WebSocketServer::stop()
+  {
+    boost::asio::post(
+      Acceptor.get_executor(),
+      [this]()
+    {
+      boost::system::error_code ignored{};
+      Acceptor.close(ignored);
+    });
+
+    std::lock_guard<std::mutex> lock{Subscribers_pt->Mutex};
+    for (const auto& session : Subscribers_pt->Sessions)
+    {
+      session.second->close();
+    }
+  } // End of stop
+
+  //=========================================================================
+  /*! \brief Send a text message to every subscriber.
+
+      \note This function is thread-safe.
+
+      \param message  The message. It is moved into a buffer shared by all
+                      the subscribers; it is not copied per subscriber.
+  */
+  //=========================================================================
+  void WebSocketServer::broadcast(std::string message)
+  {
+    const auto shared_message{
+      std::make_shared<const std::string>(std::move(message))};
+
+    std::lock_guard<std::mutex> lock{Subscribers_pt->Mutex};
+    Subscribers_pt->Pending_messages+=Subscribers_pt->Subscribers.size();
+    for (const auto& session : Subscribers_pt->Subscribers)
+    {
+      session.second->send(shared_message);
+    }
+  } // End of broadcast
+
+  //=========================================================================
+  /*! \brief The number of connected subscribers.
+  */
+  //=========================================================================
+  std::size_t WebSocketServer::subscriber_count() const
+  {
+    std::lock_guard<std::mutex> lock{Subscribers_pt->Mutex};
+    return Subscribers_pt->Subscribers.size();
+  } // End of subscriber_count
+
+  //=========================================================================
+  /*! \brief The number of messages dropped because a subscriber queue was
+             full.
+  */
+  //=========================================================================
+  std::size_t WebSocketServer::dropped_message_count() const
+  {
+    return Subscribers_pt->Dropped_messages;
+  } // End of dropped_message_count
+
+  //=========================================================================
+  /*! \brief The number of messages, summed over the subscribers, that are
+             queued or being written.
+
+      Once it drops to zero, dropped_message_count() is final for the
+      messages broadcast so far.
+  */
+  //=========================================================================
+  std::size_t WebSocketServer::pending_message_count() const
+  {
+    return Subscribers_pt->Pending_messages;
+  } // End of pending_message_count
+
+  //=========================================================================
+  /*! \brief The port the server listens on, once run() has succeeded.
+  */
+  //=========================================================================
+  unsigned short WebSocketServer::port() const
+  {
+    boost::system::error_code ignored{};
+    return Acceptor.local_endpoint(ignored).port();
+  } // End of port
+
+  // Private methods
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void WebSocketServer::listen_to_incoming_connection()
+  {
+    // Each session gets its own strand.
+    Acceptor.async_accept(
+      boost::asio::make_strand(Ioc),
+      [this](auto ec, auto socket)
+    {
+      on_accept(ec,std::move(socket));
+    });
+  } // End of listen_to_incoming_connection
+
+  //=========================================================================
+  //
+  //=========================================================================
+  void WebSocketServer::on_accept(const boost::system::error_code& ec,
+                                  boost::asio::ip::tcp::socket socket)
+  {
+    // Stop accepting once the acceptor has been closed.
+    if (ec==boost::asio::error::operation_aborted)
+    {
+      return;
+    }
+    if (ec)
+    {
+      // Typically out of file descriptors; keep accepting.
+      log("on_accept",ec);
+    }
+    else if (Ctx!=nullptr)
+    {
+      std::make_shared<BasicWebSocketSession<true>>(
+        Subscribers_pt,std::move(socket),*Ctx)->start();
+    }
+    else
+    {
+      std::make_shared<BasicWebSocketSession<false>>(
+        Subscribers_pt,std::move(socket))->start();
+    }
+    listen_to_incoming_connection();
+  } // End of on_accept
+} // namespace NetworkMonitor
@@ -0,0 +1,130 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include <network-monitor/crowding_metrics.h>
+#include <network-monitor/file_downloader.h>
+#include <network-monitor/passenger_event_parser.h>
+#include <network-monitor/station_index.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(class_CrowdingMetrics)
+{
+  using NetworkMonitor::CrowdingWindow;
+  using NetworkMonitor::PassengerDirection;
+
+  const nlohmann::json layout=
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  NetworkMonitor::CrowdingMetrics metrics{layout,stations};
+  BOOST_REQUIRE_EQUAL(metrics.line_count(),layout["lines"].size());
+
+  // station_000 is on line_000 (Bakerloo).
+  const std::uint32_t station{stations.find("station_000")};
+  const std::int64_t second{1000000};
+  const std::int64_t start{1604215130*second};
+
+  // 60 passengers enter over one minute, one per second.
+  NetworkMonitor::PassengerEvent event{};
+  event.station=station;
+  event.direction=PassengerDirection::In;
+  for (int i=0; i<60; i++)
+  {
+    event.timestamp=start+i*second;
+    BOOST_CHECK(metrics.record(event));
+  }
+  BOOST_CHECK_CLOSE(
+    metrics.station_rate(station,CrowdingWindow::FiveMinutes,
+                         PassengerDirection::In),12.0,1e-9);
+  BOOST_CHECK_EQUAL(
+    metrics.station_rate(station,CrowdingWindow::FiveMinutes,
+                         PassengerDirection::Out),0.0);
+  BOOST_CHECK_CLOSE(
+    metrics.line_rate(0,CrowdingWindow::FiveMinutes,
+                      PassengerDirection::In),12.0,1e-9);
+  BOOST_CHECK_EQUAL(
+    metrics.window_counts(CrowdingWindow::FifteenMinutes,
+                          PassengerDirection::In)[station],60);
+
+  // Two minutes later the events have left the one-minute window only.
+  metrics.advance_to(start+180*second);
+  BOOST_CHECK_EQUAL(
+    metrics.station_rate(station,CrowdingWindow::OneMinute,
+                         PassengerDirection::In),0.0);
+  BOOST_CHECK_EQUAL(
+    metrics.window_counts(CrowdingWindow::FiveMinutes,
+                          PassengerDirection::In)[station],60);
+
+  // A late event still counts towards the windows that cover it.
+  event.timestamp=start+150*second;
+  event.direction=PassengerDirection::Out;
+  BOOST_CHECK(metrics.record(event));
+  BOOST_CHECK_EQUAL(
+    metrics.window_counts(CrowdingWindow::OneMinute,
+                          PassengerDirection::Out)[station],1);
+
+  // Too late for any window
+  event.timestamp=start-3600*second;
+  BOOST_CHECK(!metrics.record(event));
+
+  // After fifteen minutes everything has expired.
+  metrics.advance_to(start+1200*second);
+  BOOST_CHECK_EQUAL(
+    metrics.window_counts(CrowdingWindow::FifteenMinutes,
+                          PassengerDirection::In)[station],0);
+  BOOST_CHECK_EQUAL(
+    metrics.window_counts(CrowdingWindow::FifteenMinutes,
+                          PassengerDirection::Out)[station],0);
+} // BOOST_AUTO_TEST_CASE(class_CrowdingMetrics)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(CrowdingMetrics_bucket_expiry)
+{
+  using NetworkMonitor::CrowdingWindow;
+  using NetworkMonitor::PassengerDirection;
+
+  const NetworkMonitor::StationIndex stations
+  {
+    std::vector<std::string>{"station_000"}
+  };
+  NetworkMonitor::CrowdingMetrics metrics
+  {
+    nlohmann::json::object(),stations,std::chrono::seconds(10)
+  };
+
+  // One event per bucket; stepping one bucket at a time must drop exactly
+  // the oldest one from the one-minute window.
+  NetworkMonitor::PassengerEvent event{};
+  event.station=0;
+  const std::int64_t bucket{10000000};
+  for (int i=0; i<12; i++)
+  {
+    event.timestamp=i*bucket;
+    metrics.record(event);
+    const std::uint32_t expected{static_cast<std::uint32_t>(std::min(i+1,6))};
+    BOOST_CHECK_EQUAL(
+      metrics.window_counts(CrowdingWindow::OneMinute,
+                            PassengerDirection::In)[0],expected);
+  }
+  BOOST_CHECK_EQUAL(
+    metrics.window_counts(CrowdingWindow::FifteenMinutes,
+                          PassengerDirection::In)[0],12);
+} // BOOST_AUTO_TEST_CASE(CrowdingMetrics_bucket_expiry)
+
+//=========================================================================
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,383 @@
+// Headers we've defined
+#include "network-monitor/endpoint_selector.h"
+#include "network-monitor/tls_context.h"
+#include "network-monitor/websocket_server.h"
+
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+
+// Regular libraries
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+//=========================================================================
+// Loopback TCP relay to a local server. It holds every chunk of data it
+// forwards, both ways, for a delay that can change at any time, to make
+// one endpoint slower than the others.
+//=========================================================================
+class DelayRelay
+{
+public:
+  DelayRelay(boost::asio::io_context& ioc, unsigned short target_port) :
+    Ioc(ioc),
+    Acceptor(ioc,{boost::asio::ip::make_address("127.0.0.1"),0}),
+    Target(boost::asio::ip::make_address("127.0.0.1"),target_port)
+  {
+    accept();
+  }
+
+  unsigned short port() const
+  {
+    return Acceptor.local_endpoint().port();
+  }
+
+  void set_delay(std::chrono::milliseconds delay)
+  {
+    Delay=delay;
+  }
+
+  void stop()
+  {
+    boost::system::error_code ignored{};
+    Acceptor.close(ignored);
+    for (auto& socket : Sockets)
+    {
+      socket->close(ignored);
+    }
+  }
+
+private:
+  using tcp = boost::asio::ip::tcp;
+
+  boost::asio::io_context& Ioc;
+  tcp::acceptor Acceptor;
+  tcp::endpoint Target;
+  std::chrono::milliseconds Delay{0};
+  std::vector<std::shared_ptr<tcp::socket>> Sockets{};
+
+  void accept()
+  {
+    Acceptor.async_accept(
+      [this](auto ec, tcp::socket socket)
+    {
+      if (ec)
+      {
+        return;
+      }
+      auto downstream{std::make_shared<tcp::socket>(std::move(socket))};
+      auto upstream{std::make_shared<tcp::socket>(Ioc)};
+      Sockets.push_back(downstream);
+      Sockets.push_back(upstream);
+      upstream->async_connect(
+        Target,
+        [this,downstream,upstream](auto ec)
+      {
+        if (ec)
+        {
+          downstream->close(ec);
+          return;
+        }
+        forward(downstream,upstream);
+        forward(upstream,downstream);
+      });
+      accept();
+    });
+  }
+
+  // Read a chunk, hold it for the delay, write it and start again.
+  void forward(std::shared_ptr<tcp::socket> from,
+               std::shared_ptr<tcp::socket> to)
+  {
+    auto buffer{std::make_shared<std::array<char,4096>>()};
+    from->async_read_some(
+      boost::asio::buffer(*buffer),
+      [this,from,to,buffer](auto ec, auto n_bytes)
+    {
+      if (ec)
+      {
+        to->close(ec);
+        return;
+      }
+      auto timer{std::make_shared<boost::asio::steady_timer>(Ioc,Delay)};
+      timer->async_wait(
+        [this,from,to,buffer,timer,n_bytes](auto)
+      {
+        boost::asio::async_write(
+          *to,boost::asio::buffer(*buffer,n_bytes),
+          [this,from,to,buffer](auto ec, auto)
+        {
+          if (ec)
+          {
+            from->close(ec);
+            return;
+          }
+          forward(from,to);
+        });
+      });
+    });
+  }
+};
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(class_EndpointSelector)
+{
+  // The first candidate does not exist, so only the second one is healthy.
+  std::vector<NetworkMonitor::WebSocketEndpoint> candidates
+  {
+    {"invalid.learncppthroughprojects.com","/network-events","443"},
+    {"ltnm.learncppthroughprojects.com","/network-events","443"}
+  };
+
+  // Always start with an I/O context object.
+  boost::asio::io_context ioc{};
+
+  // TLS context for a secure WebSocket connection. The Certificate
+  // Authority (CA) entities are loaded once and shared by every test.
+  auto ctx{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  BOOST_REQUIRE(ctx!=nullptr);
+
+  // The class under test
+  NetworkMonitor::EndpointSelectorOptions options{};
+  options.probe_pings=2;
+  options.probe_interval=std::chrono::milliseconds(50);
+  NetworkMonitor::EndpointSelector selector{candidates,ioc,*ctx,options};
+
+  bool connected{false};
+  bool disconnected{false};
+  std::string selected_url{};
+  auto on_close{[&disconnected](auto err_code)
+  {
+    disconnected=!err_code;
+  }};
+  auto on_connect{[&selector,&connected,&selected_url,&on_close](auto err_code)
+  {
+    connected=!err_code;
+    if (connected)
+    {
+      selected_url=selector.active_endpoint()->url;
+    }
+    selector.close(on_close);
+  }};
+
+  // We must call io_context::run for asynchronous callbacks to run.
+  selector.connect(on_connect);
+  ioc.run();
+
+  BOOST_CHECK(connected);
+  BOOST_CHECK(disconnected);
+  BOOST_CHECK_EQUAL(selected_url,candidates[1].url);
+} // BOOST_AUTO_TEST_CASE(class_EndpointSelector)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(EndpointSelector_no_healthy_endpoint)
+{
+  std::vector<NetworkMonitor::WebSocketEndpoint> candidates
+  {
+    {"invalid.learncppthroughprojects.com","/network-events","443"}
+  };
+  boost::asio::io_context ioc{};
+  auto ctx{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  BOOST_REQUIRE(ctx!=nullptr);
+  NetworkMonitor::EndpointSelector selector{candidates,ioc,*ctx};
+
+  boost::system::error_code connect_error{};
+  selector.connect([&connect_error](auto err_code)
+  {
+    connect_error=err_code;
+  });
+  ioc.run();
+
+  BOOST_CHECK(connect_error);
+  BOOST_CHECK(selector.active_endpoint()==nullptr);
+} // BOOST_AUTO_TEST_CASE(EndpointSelector_no_healthy_endpoint)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(EndpointSelector_failover)
+{
+  boost::asio::io_context ioc{};
+  // The local servers have a self-signed certificate: it is its own CA.
+  auto server_ctx{NetworkMonitor::make_tls_server_context(
+    TESTS_SERVER_CERT_PEM,TESTS_SERVER_KEY_PEM)};
+  auto client_ctx{NetworkMonitor::make_tls_client_context(
+    TESTS_SERVER_CERT_PEM)};
+  BOOST_REQUIRE(server_ctx!=nullptr);
+  BOOST_REQUIRE(client_ctx!=nullptr);
+
+  // Two local servers; both are healthy to start with.
+  std::vector<std::unique_ptr<NetworkMonitor::WebSocketServer>> servers{};
+  std::vector<NetworkMonitor::WebSocketEndpoint> candidates{};
+  for (int i=0; i<2; i++)
+  {
+    servers.push_back(std::make_unique<NetworkMonitor::WebSocketServer>(
+      "127.0.0.1",0,ioc,*server_ctx));
+    BOOST_REQUIRE(!servers.back()->run());
+    candidates.push_back(
+      {"127.0.0.1","/",std::to_string(servers.back()->port())});
+  }
+
+  // The class under test
+  NetworkMonitor::EndpointSelectorOptions options{};
+  options.probe_pings=2;
+  options.probe_interval=std::chrono::milliseconds(20);
+  options.probe_timeout=std::chrono::milliseconds(1000);
+  options.ping_interval=std::chrono::milliseconds(50);
+  NetworkMonitor::EndpointSelector selector{candidates,ioc,*client_ctx,
+                                            options};
+
+  // Give up if the selector never fails over.
+  boost::asio::steady_timer deadline{ioc,std::chrono::seconds(10)};
+  deadline.async_wait([&](auto err_code)
+  {
+    if (!err_code)
+    {
+      selector.close();
+      for (auto& server : servers)
+      {
+        server->stop();
+      }
+    }
+  });
+
+  // Take the first server down once we are connected to it; the selector
+  // must move to the other one.
+  std::vector<std::string> connected_ports{};
+  std::size_t n_disconnects{0};
+  auto on_connect{[&](auto err_code)
+  {
+    BOOST_REQUIRE(!err_code);
+    const std::string port{selector.active_endpoint()->port};
+    connected_ports.push_back(port);
+    const std::size_t active{(port==candidates[0].port) ? 0u : 1u};
+    if (connected_ports.size()==1)
+    {
+      servers[active]->stop();
+    }
+    else
+    {
+      selector.close();
+      servers[active]->stop();
+      deadline.cancel();
+    }
+  }};
+  auto on_disconnect{[&n_disconnects](auto)
+  {
+    n_disconnects++;
+  }};
+
+  // We must call io_context::run for asynchronous callbacks to run.
+  selector.connect(on_connect,nullptr,on_disconnect);
+  ioc.run();
+
+  BOOST_REQUIRE_EQUAL(connected_ports.size(),2);
+  BOOST_CHECK(connected_ports[0]!=connected_ports[1]);
+  BOOST_CHECK_EQUAL(n_disconnects,1);
+} // BOOST_AUTO_TEST_CASE(EndpointSelector_failover)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(EndpointSelector_slow_endpoint)
+{
+  boost::asio::io_context ioc{};
+
+  // The local servers have a self-signed certificate: it is its own CA.
+  auto server_ctx{NetworkMonitor::make_tls_server_context(
+    TESTS_SERVER_CERT_PEM,TESTS_SERVER_KEY_PEM)};
+  auto client_ctx{NetworkMonitor::make_tls_client_context(
+    TESTS_SERVER_CERT_PEM)};
+  BOOST_REQUIRE(server_ctx!=nullptr);
+  BOOST_REQUIRE(client_ctx!=nullptr);
+
+  // Two local servers, each behind a relay that can slow it down
+  std::vector<std::unique_ptr<NetworkMonitor::WebSocketServer>> servers{};
+  std::vector<std::unique_ptr<DelayRelay>> relays{};
+  std::vector<NetworkMonitor::WebSocketEndpoint> candidates{};
+  for (int i=0; i<2; i++)
+  {
+    servers.push_back(std::make_unique<NetworkMonitor::WebSocketServer>(
+      "127.0.0.1",0,ioc,*server_ctx));
+    BOOST_REQUIRE(!servers.back()->run());
+    relays.push_back(std::make_unique<DelayRelay>(
+      ioc,servers.back()->port()));
+    candidates.push_back(
+      {"127.0.0.1","/",std::to_string(relays.back()->port())});
+  }
+
+  // The class under test. The pongs of the slowed down endpoint still
+  // arrive within the ping interval: only its round-trip time degrades.
+  NetworkMonitor::EndpointSelectorOptions options{};
+  options.probe_pings=2;
+  options.probe_interval=std::chrono::milliseconds(20);
+  options.probe_timeout=std::chrono::milliseconds(1000);
+  options.ping_interval=std::chrono::milliseconds(100);
+  options.degradation_factor=2.0;
+  options.min_samples=4;
+  options.max_missed_pongs=1000;
+  NetworkMonitor::EndpointSelector selector{candidates,ioc,*client_ctx,
+                                            options};
+
+  auto stop{[&]()
+  {
+    selector.close();
+    for (std::size_t i=0; i<servers.size(); i++)
+    {
+      relays[i]->stop();
+      servers[i]->stop();
+    }
+  }};
+
+  // Give up if the selector never migrates.
+  boost::asio::steady_timer deadline{ioc,std::chrono::seconds(10)};
+  deadline.async_wait([&stop](auto err_code)
+  {
+    if (!err_code)
+    {
+      stop();
+    }
+  });
+
+  // Slow down the endpoint we connect to first; the selector must move to
+  // the other one.
+  std::vector<std::string> connected_ports{};
+  std::size_t n_disconnects{0};
+  auto on_connect{[&](auto err_code)
+  {
+    BOOST_REQUIRE(!err_code);
+    const std::string port{selector.active_endpoint()->port};
+    connected_ports.push_back(port);
+    const std::size_t active{(port==candidates[0].port) ? 0u : 1u};
+    if (connected_ports.size()==1)
+    {
+      relays[active]->set_delay(std::chrono::milliseconds(20));
+    }
+    else
+    {
+      deadline.cancel();
+      stop();
+    }
+  }};
+  auto on_disconnect{[&n_disconnects](auto)
+  {
+    n_disconnects++;
+  }};
+
+  // We must call io_context::run for asynchronous callbacks to run.
+  selector.connect(on_connect,nullptr,on_disconnect);
+  ioc.run();
+
+  BOOST_REQUIRE_EQUAL(connected_ports.size(),2);
+  BOOST_CHECK(connected_ports[0]!=connected_ports[1]);
+  BOOST_CHECK_EQUAL(n_disconnects,0);
+} // BOOST_AUTO_TEST_CASE(EndpointSelector_slow_endpoint)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,207 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include <network-monitor/event_log.h>
+#include <network-monitor/file_downloader.h>
+#include <network-monitor/passenger_event_generator.h>
+#include <network-monitor/passenger_event_parser.h>
+#include <network-monitor/station_index.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+// Read a whole time range of a log back as events
+static std::vector<NetworkMonitor::PassengerEvent> read_events(
+  const NetworkMonitor::EventLogReader& reader,
+  std::int64_t from,
+  std::int64_t to,
+  std::size_t* n_batches=nullptr)
+{
+  std::vector<NetworkMonitor::PassengerEvent> events{};
+  const std::size_t n_visited{reader.scan(from,to,[&](const auto& batch)
+  {
+    for (std::size_t i=0; i<batch.size; i++)
+    {
+      events.push_back({batch.timestamps[i],batch.stations[i],
+                        batch.directions[i]});
+    }
+    if (n_batches!=nullptr)
+    {
+      (*n_batches)++;
+    }
+  })};
+  BOOST_CHECK_EQUAL(n_visited,events.size());
+  return events;
+} // End of read_events
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(class_EventLogWriter)
+{
+  const nlohmann::json layout=
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  NetworkMonitor::PassengerEventGenerator generator{layout,stations};
+  const auto directory
+  {
+    std::filesystem::temp_directory_path() / "network-monitor-event-log"
+  };
+  std::filesystem::remove_all(directory);
+
+  // 10 blocks of 1000 events, 3 blocks per segment.
+  std::vector<NetworkMonitor::PassengerEvent> events(10000);
+  {
+    NetworkMonitor::EventLogWriter writer{directory,{1000,3}};
+    for (auto& event : events)
+    {
+      BOOST_REQUIRE(generator.next(event));
+      BOOST_REQUIRE(writer.append(event));
+    }
+    BOOST_CHECK_EQUAL(writer.size(),events.size());
+  }
+
+  NetworkMonitor::EventLogReader reader{directory};
+  BOOST_CHECK_EQUAL(reader.size(),events.size());
+  BOOST_CHECK_EQUAL(reader.segment_count(),4);
+  BOOST_CHECK_EQUAL(reader.block_count(),10);
+  BOOST_CHECK_EQUAL(reader.min_time(),events.front().timestamp);
+  BOOST_CHECK_EQUAL(reader.max_time(),events.back().timestamp);
+
+  // Everything comes back.
+  const auto all{read_events(reader,reader.min_time(),reader.max_time()+1)};
+  BOOST_REQUIRE_EQUAL(all.size(),events.size());
+  for (std::size_t i=0; i<events.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(all[i].timestamp,events[i].timestamp);
+    BOOST_REQUIRE_EQUAL(all[i].station,events[i].station);
+    BOOST_REQUIRE(all[i].direction==events[i].direction);
+  }
+
+  // A time range only reads the blocks that overlap it.
+  const std::int64_t from{events[2500].timestamp};
+  const std::int64_t to{events[4200].timestamp};
+  std::size_t n_batches{0};
+  const auto range{read_events(reader,from,to,&n_batches)};
+  std::size_t n_expected{0};
+  for (const auto& event : events)
+  {
+    n_expected+=(event.timestamp>=from) && (event.timestamp<to);
+  }
+  BOOST_CHECK_EQUAL(range.size(),n_expected);
+  BOOST_CHECK_EQUAL(n_batches,3);
+  for (const auto& event : range)
+  {
+    BOOST_CHECK((event.timestamp>=from) && (event.timestamp<to));
+  }
+  BOOST_CHECK(read_events(reader,0,reader.min_time()).empty());
+
+  // Clean up.
+  reader={};
+  std::filesystem::remove_all(directory);
+} // BOOST_AUTO_TEST_CASE(class_EventLogWriter)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(EventLogWriter_append_message)
+{
+  const nlohmann::json layout=
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  const NetworkMonitor::PassengerEventParser parser{stations};
+  const auto directory
+  {
+    std::filesystem::temp_directory_path() / "network-monitor-event-log"
+  };
+  std::filesystem::remove_all(directory);
+
+  // Events out of order and wide apart, and station IDs that need more
+  // than one byte
+  const std::vector<NetworkMonitor::PassengerEvent> events
+  {
+    {1604215130234000,stations.find("station_042"),
+     NetworkMonitor::PassengerDirection::In},
+    {1604215130000000,stations.find("station_300"),
+     NetworkMonitor::PassengerDirection::Out},
+    {0,stations.find("station_000"),NetworkMonitor::PassengerDirection::In},
+    {4102444799999999,stations.find("station_001"),
+     NetworkMonitor::PassengerDirection::Out},
+  };
+
+  // Several frames in one message, with one that is not a passenger event.
+  std::string message{};
+  for (const auto& event : events)
+  {
+    NetworkMonitor::append_passenger_event_frame(event,stations,message);
+  }
+  message+="MESSAGE\ndestination:/passengers\n\n{}";
+  message.push_back('\0');
+  {
+    NetworkMonitor::EventLogWriter writer{directory};
+    BOOST_CHECK_EQUAL(writer.append_message(message,parser),events.size());
+  }
+
+  // A second writer adds a segment, after the one another writer took in
+  // the meantime.
+  {
+    NetworkMonitor::EventLogWriter writer{directory};
+    std::ofstream{directory / "segment-000001.evlog"};
+    BOOST_CHECK(writer.append(events[0]));
+    BOOST_CHECK(writer.flush());
+    BOOST_CHECK_EQUAL(writer.dropped_event_count(),0);
+  }
+  BOOST_CHECK(std::filesystem::exists(directory / "segment-000002.evlog"));
+  std::filesystem::remove(directory / "segment-000001.evlog");
+
+  NetworkMonitor::EventLogReader reader{directory};
+  BOOST_CHECK_EQUAL(reader.segment_count(),2);
+  BOOST_CHECK_EQUAL(reader.min_time(),0);
+  BOOST_CHECK_EQUAL(reader.max_time(),4102444799999999);
+  const auto all{read_events(reader,reader.min_time(),reader.max_time()+1)};
+  BOOST_REQUIRE_EQUAL(all.size(),events.size()+1);
+  for (std::size_t i=0; i<all.size(); i++)
+  {
+    const auto& event{events[i%events.size()]};
+    BOOST_CHECK_EQUAL(all[i].timestamp,event.timestamp);
+    BOOST_CHECK_EQUAL(all[i].station,event.station);
+    BOOST_CHECK(all[i].direction==event.direction);
+  }
+  reader={};
+
+  // A segment cut short keeps its complete blocks.
+  const auto segment{directory / "segment-000000.evlog"};
+  std::filesystem::resize_file(segment,
+                               std::filesystem::file_size(segment)-8);
+  BOOST_CHECK_EQUAL(NetworkMonitor::EventLogReader{directory}.size(),1);
+  BOOST_CHECK_EQUAL(NetworkMonitor::EventLogReader{"does-not-exist"}.size(),
+                    0);
+
+  // Blocks that cannot be written are reported, not counted: the log
+  // directory is a regular file here.
+  {
+    NetworkMonitor::EventLogWriter writer{segment,{3,1}};
+    std::size_t n_dropped{0};
+    BOOST_CHECK_EQUAL(writer.append_message(message,parser,&n_dropped),3);
+    BOOST_CHECK_EQUAL(n_dropped,3);
+    BOOST_CHECK_EQUAL(writer.size(),1);
+    BOOST_CHECK_EQUAL(writer.dropped_event_count(),3);
+  }
+
+  // Clean up.
+  std::filesystem::remove_all(directory);
+} // BOOST_AUTO_TEST_CASE(EventLogWriter_append_message)
+
+//=========================================================================
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,84 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+
+// Headers we've defined
+#include <network-monitor/heavy_hitters.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(class_CountMinSketch)
+{
+  NetworkMonitor::CountMinSketch sketch{1000,4};
+  std::unordered_map<std::uint64_t,std::uint64_t> counts{};
+
+  std::mt19937_64 generator{7};
+  std::uniform_int_distribution<std::uint64_t> key(0,99999);
+  for (int i=0; i<100000; i++)
+  {
+    const std::uint64_t k{key(generator)};
+    sketch.add(k);
+    counts[k]++;
+  }
+  BOOST_CHECK_EQUAL(sketch.total(),100000);
+
+  // Never undercounts, and rarely overcounts by more than 2*total/width.
+  std::size_t far_off{0};
+  for (const auto& [k,count] : counts)
+  {
+    const std::uint64_t estimate{sketch.estimate(k)};
+    BOOST_CHECK(estimate>=count);
+    if (estimate>count+2*100000/1024)
+    {
+      far_off++;
+    }
+  }
+  BOOST_CHECK(far_off<counts.size()/10);
+
+  sketch.clear();
+  BOOST_CHECK_EQUAL(sketch.total(),0);
+  BOOST_CHECK_EQUAL(sketch.estimate(counts.begin()->first),0);
+} // BOOST_AUTO_TEST_CASE(class_CountMinSketch)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(class_HeavyHitters)
+{
+  // A few heavy edges hidden in a long tail of light ones
+  NetworkMonitor::HeavyHitters hitters{5,2048,4};
+  const std::uint64_t cycle[]{5,5,5,5,5,4,4,4,4,3,3,3,2,2,1};
+  std::mt19937_64 generator{11};
+  std::uniform_int_distribution<std::uint64_t> tail(1000,1000000);
+  for (int i=0; i<200000; i++)
+  {
+    if (i%10==0)
+    {
+      // Keys 1 to 5, key n being n times as frequent as key 1
+      hitters.add(cycle[(i/10)%15]);
+    }
+    else
+    {
+      hitters.add(tail(generator));
+    }
+  }
+
+  const auto top{hitters.sorted_top()};
+  BOOST_REQUIRE_EQUAL(top.size(),5);
+  for (std::uint64_t i=0; i<5; i++)
+  {
+    BOOST_CHECK_EQUAL(top[i].key,5-i);
+    BOOST_CHECK(top[i].count>=(5-i)*(20000/15));
+  }
+
+  hitters.clear();
+  BOOST_CHECK(hitters.top().empty());
+} // BOOST_AUTO_TEST_CASE(class_HeavyHitters)
+
+BOOST_AUTO_TEST_SUITE_END();
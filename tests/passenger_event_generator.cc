@@ -0,0 +1,144 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include <network-monitor/file_downloader.h>
+#include <network-monitor/passenger_event_generator.h>
+#include <network-monitor/passenger_event_parser.h>
+#include <network-monitor/station_index.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(class_PassengerEventGenerator)
+{
+  const nlohmann::json layout=
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  NetworkMonitor::PassengerEventGenerator generator{layout,stations};
+  BOOST_CHECK(generator.route_count()>0);
+
+  // Events come out in order, and every passenger who gets in gets out.
+  const NetworkMonitor::PassengerEventParser parser{stations};
+  std::int64_t previous{0};
+  std::size_t n_in{0};
+  std::size_t n_out{0};
+  std::string frame{};
+  for (int i=0; i<20000; i++)
+  {
+    NetworkMonitor::PassengerEvent event{};
+    BOOST_REQUIRE(generator.next(event));
+    BOOST_CHECK(event.timestamp>=previous);
+    BOOST_CHECK(event.station<stations.size());
+    previous=event.timestamp;
+    if (event.direction==NetworkMonitor::PassengerDirection::In)
+    {
+      n_in++;
+    }
+    else
+    {
+      n_out++;
+    }
+
+    // The frames decode back to the same event.
+    frame.clear();
+    NetworkMonitor::append_passenger_event_frame(event,stations,frame);
+    NetworkMonitor::PassengerEvent decoded{};
+    BOOST_REQUIRE(parser.parse_stomp_frame(frame,decoded));
+    BOOST_CHECK_EQUAL(decoded.timestamp,event.timestamp);
+    BOOST_CHECK_EQUAL(decoded.station,event.station);
+    BOOST_CHECK(decoded.direction==event.direction);
+  }
+  BOOST_CHECK(n_in>=n_out);
+  BOOST_CHECK(n_out>0);
+
+  // Rush hours
+  const std::int64_t midnight{1604188800000000};
+  const std::int64_t hour{3600000000};
+  BOOST_CHECK_CLOSE(generator.demand(midnight+3*hour),1.0,1.0);
+  BOOST_CHECK_CLOSE(generator.demand(midnight+8*hour+hour/2),3.0,1.0);
+} // BOOST_AUTO_TEST_CASE(class_PassengerEventGenerator)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(PassengerEventGenerator_trip_timing)
+{
+  // One route A -> B -> C, 2 then 3 minutes apart
+  const nlohmann::json layout=nlohmann::json::parse(R"({
+    "stations": [
+      {"station_id": "A", "name": "A"},
+      {"station_id": "B", "name": "B"},
+      {"station_id": "C", "name": "C"}
+    ],
+    "lines": [{
+      "line_id": "line_0",
+      "routes": [{"route_id": "route_0", "route_stops": ["A", "B", "C"]}]
+    }],
+    "travel_times": [
+      {"route_id": "route_0", "start_station_id": "A",
+       "end_station_id": "B", "travel_time": 2},
+      {"route_id": "route_0", "start_station_id": "B",
+       "end_station_id": "C", "travel_time": 3}
+    ]
+  })");
+  const NetworkMonitor::StationIndex stations{layout};
+  const std::uint32_t a{stations.find("A")};
+  const std::uint32_t b{stations.find("B")};
+  const std::uint32_t c{stations.find("C")};
+
+  // One trip an hour at most, no waiting: each "in" is directly followed
+  // by its "out".
+  NetworkMonitor::PassengerEventGeneratorOptions options{};
+  options.trips_per_second=1.0e-6;
+  options.max_wait_seconds=0.0;
+  options.rush_hours.clear();
+  NetworkMonitor::PassengerEventGenerator generator{layout,stations,options};
+  BOOST_REQUIRE_EQUAL(generator.route_count(),1);
+
+  const std::int64_t minute{60000000};
+  for (int i=0; i<100; i++)
+  {
+    NetworkMonitor::PassengerEvent in{};
+    NetworkMonitor::PassengerEvent out{};
+    BOOST_REQUIRE(generator.next(in));
+    BOOST_REQUIRE(generator.next(out));
+    BOOST_REQUIRE(in.direction==NetworkMonitor::PassengerDirection::In);
+    BOOST_REQUIRE(out.direction==NetworkMonitor::PassengerDirection::Out);
+    const std::int64_t duration{out.timestamp-in.timestamp};
+    if (in.station==a)
+    {
+      BOOST_CHECK((out.station==b) || (out.station==c));
+      BOOST_CHECK_EQUAL(duration,(out.station==b ? 2 : 5)*minute);
+    }
+    else
+    {
+      BOOST_CHECK_EQUAL(in.station,b);
+      BOOST_CHECK_EQUAL(out.station,c);
+      BOOST_CHECK_EQUAL(duration,3*minute);
+    }
+  }
+
+  // A hotspot draws most of the trips.
+  options.hotspots.push_back({"C",100.0});
+  options.trips_per_second=0.1;
+  NetworkMonitor::PassengerEventGenerator hot{layout,stations,options};
+  std::size_t n_c{0};
+  for (int i=0; i<1000; i++)
+  {
+    NetworkMonitor::PassengerEvent event{};
+    hot.next(event);
+    n_c+=(event.station==c);
+  }
+  BOOST_CHECK(n_c>400);
+} // BOOST_AUTO_TEST_CASE(PassengerEventGenerator_trip_timing)
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,142 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <cstdint>
+#include <string>
+
+// Headers we've defined
+#include <network-monitor/file_downloader.h>
+#include <network-monitor/passenger_event_parser.h>
+#include <network-monitor/station_index.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(parse_iso8601_timestamp)
+{
+  std::int64_t timestamp{0};
+  BOOST_CHECK(NetworkMonitor::parse_iso8601_timestamp(
+    "1970-01-01T00:00:00Z",timestamp));
+  BOOST_CHECK_EQUAL(timestamp,0);
+
+  // 2020-11-01T07:18:50Z is 1604215130 seconds after the epoch.
+  BOOST_CHECK(NetworkMonitor::parse_iso8601_timestamp(
+    "2020-11-01T07:18:50.234000Z",timestamp));
+  BOOST_CHECK_EQUAL(timestamp,1604215130234000);
+  BOOST_CHECK(NetworkMonitor::parse_iso8601_timestamp(
+    "2020-11-01T07:18:50.2345678",timestamp));
+  BOOST_CHECK_EQUAL(timestamp,1604215130234567);
+
+  BOOST_CHECK(!NetworkMonitor::parse_iso8601_timestamp(
+    "2020-11-01",timestamp));
+  BOOST_CHECK(!NetworkMonitor::parse_iso8601_timestamp(
+    "2020-13-01T07:18:50Z",timestamp));
+  BOOST_CHECK(!NetworkMonitor::parse_iso8601_timestamp(
+    "2020-11-01T07:18:50.Z",timestamp));
+} // BOOST_AUTO_TEST_CASE(parse_iso8601_timestamp)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(append_iso8601_timestamp)
+{
+  std::string text{};
+  NetworkMonitor::append_iso8601_timestamp(1604215130234000,text);
+  BOOST_CHECK_EQUAL(text,"2020-11-01T07:18:50.234000Z");
+
+  // Round trips, including leap days and dates before the epoch
+  for (const std::int64_t timestamp : {std::int64_t{0},
+                                       std::int64_t{951782400000001},
+                                       std::int64_t{-1},
+                                       std::int64_t{4102444799999999}})
+  {
+    text.clear();
+    NetworkMonitor::append_iso8601_timestamp(timestamp,text);
+    std::int64_t parsed{0};
+    BOOST_CHECK(NetworkMonitor::parse_iso8601_timestamp(text,parsed));
+    BOOST_CHECK_EQUAL(parsed,timestamp);
+  }
+} // BOOST_AUTO_TEST_CASE(append_iso8601_timestamp)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(class_PassengerEventParser)
+{
+  const NetworkMonitor::StationIndex stations
+  {
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON)
+  };
+  const NetworkMonitor::PassengerEventParser parser{stations};
+
+  // Fields in any order, unknown keys of any type, long values that span
+  // several SIMD blocks.
+  const std::string body
+  {
+    "{\n"
+    "  \"passenger_event\": \"out\",\n"
+    "  \"extra\": {\"a\": [1, \"}\", {\"b\": null}], \"c\": \"\\\"\"},\n"
+    "  \"count\": 12,\n"
+    "  \"note\": \"a fairly long string value that spans many bytes\",\n"
+    "  \"station_id\": \"station_042\",\n"
+    "  \"datetime\": \"2020-11-01T07:18:50.234000Z\"\n"
+    "}"
+  };
+  NetworkMonitor::PassengerEvent event{};
+  BOOST_REQUIRE(parser.parse(body,event));
+  BOOST_CHECK_EQUAL(event.station,stations.find("station_042"));
+  BOOST_CHECK(event.direction==NetworkMonitor::PassengerDirection::Out);
+  BOOST_CHECK_EQUAL(event.timestamp,1604215130234000);
+
+  // The same event inside a STOMP MESSAGE frame.
+  const std::string frame
+  {
+    "MESSAGE\n"
+    "destination:/passengers\n"
+    "content-type:application/json\n"
+    "\n"+body+std::string(1,'\0')
+  };
+  NetworkMonitor::PassengerEvent stomp_event{};
+  BOOST_REQUIRE(parser.parse_stomp_frame(frame,stomp_event));
+  BOOST_CHECK_EQUAL(stomp_event.station,event.station);
+  BOOST_CHECK_EQUAL(stomp_event.timestamp,event.timestamp);
+} // BOOST_AUTO_TEST_CASE(class_PassengerEventParser)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(PassengerEventParser_invalid_input)
+{
+  const NetworkMonitor::StationIndex stations
+  {
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON)
+  };
+  const NetworkMonitor::PassengerEventParser parser{stations};
+  NetworkMonitor::PassengerEvent event{};
+
+  // Missing field
+  BOOST_CHECK(!parser.parse(
+    "{\"station_id\": \"station_000\", \"passenger_event\": \"in\"}",event));
+
+  // Unknown station
+  BOOST_CHECK(!parser.parse(
+    "{\"station_id\": \"station_999\", \"passenger_event\": \"in\","
+    " \"datetime\": \"2020-11-01T07:18:50Z\"}",event));
+
+  // Unknown direction
+  BOOST_CHECK(!parser.parse(
+    "{\"station_id\": \"station_000\", \"passenger_event\": \"up\","
+    " \"datetime\": \"2020-11-01T07:18:50Z\"}",event));
+
+  // Truncated input and not an object
+  BOOST_CHECK(!parser.parse("{\"station_id\": \"stat",event));
+  BOOST_CHECK(!parser.parse("[]",event));
+  BOOST_CHECK(!parser.parse("",event));
+  BOOST_CHECK(!parser.parse_stomp_frame("MESSAGE\n",event));
+} // BOOST_AUTO_TEST_CASE(PassengerEventParser_invalid_input)
+
+//=========================================================================
+
+BOOST_AUTO_TEST_SUITE_END();
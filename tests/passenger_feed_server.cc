@@ -0,0 +1,133 @@
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include <network-monitor/file_downloader.h>
+#include <network-monitor/passenger_event_generator.h>
+#include <network-monitor/passenger_event_parser.h>
+#include <network-monitor/passenger_feed_server.h>
+#include <network-monitor/station_index.h>
+#include <network-monitor/tls_context.h>
+#include <network-monitor/websocket_client.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(class_PassengerFeedServer)
+{
+  const nlohmann::json layout=
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  NetworkMonitor::PassengerEventGenerator generator{layout,stations};
+  std::vector<NetworkMonitor::PassengerEvent> events(100);
+  for (auto& event : events)
+  {
+    BOOST_REQUIRE(generator.next(event));
+  }
+
+  // The server has a self-signed certificate: it is its own CA.
+  boost::asio::io_context ioc{};
+  auto server_ctx{NetworkMonitor::make_tls_server_context(
+    TESTS_SERVER_CERT_PEM,TESTS_SERVER_KEY_PEM)};
+  auto client_ctx{NetworkMonitor::make_tls_client_context(
+    TESTS_SERVER_CERT_PEM)};
+  BOOST_REQUIRE(server_ctx!=nullptr);
+  BOOST_REQUIRE(client_ctx!=nullptr);
+
+  // The class under test, and the client we use against the live feed
+  NetworkMonitor::PassengerFeedServer server{
+    "127.0.0.1",0,ioc,*server_ctx,stations};
+  BOOST_REQUIRE(!server.run());
+  const std::string url{"127.0.0.1"};
+  const std::string endpoint{"/passengers"};
+  const std::string port{std::to_string(server.port())};
+  NetworkMonitor::WebSocketClient client{url,endpoint,port,ioc,*client_ctx};
+
+  // STOMP frames; the body must be followed by a NULL octet.
+  std::string connect_frame{"CONNECT\n"
+                            "accept-version:1.2\n"
+                            "host:localhost\n"
+                            "\n"};
+  connect_frame.push_back('\0');
+  std::string subscribe_frame{"SUBSCRIBE\n"
+                              "destination:/passengers\n"
+                              "id:0\n"
+                              "receipt:subscribed\n"
+                              "\n"};
+  subscribe_frame.push_back('\0');
+
+  const NetworkMonitor::PassengerEventParser parser{stations};
+  const auto start{std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count()};
+  bool connected{false};
+  bool subscribed{false};
+  bool stamped{true};
+  std::vector<NetworkMonitor::PassengerEvent> received{};
+  auto on_connect{[&client,&connect_frame](auto err_code)
+  {
+    BOOST_REQUIRE(!err_code);
+    client.send(connect_frame);
+  }};
+  auto on_message{[&](auto err_code, auto message)
+  {
+    BOOST_REQUIRE(!err_code);
+    if (message.rfind("CONNECTED\n",0)==0)
+    {
+      connected=true;
+      client.send(subscribe_frame);
+    }
+    else if (message.rfind("RECEIPT\n",0)==0)
+    {
+      subscribed=(message.find("receipt-id:subscribed\n")!=
+                  std::string::npos);
+      BOOST_CHECK_EQUAL(server.subscriber_count(),1);
+      for (const auto& event : events)
+      {
+        server.publish(event);
+      }
+    }
+    else
+    {
+      // One frame per message, as on the live feed
+      NetworkMonitor::PassengerEvent event{};
+      BOOST_REQUIRE(parser.parse_stomp_frame(message,event));
+      received.push_back(event);
+      std::int64_t sent_at{0};
+      stamped&=NetworkMonitor::parse_passenger_event_frame_sent_at(
+        message,sent_at) && (sent_at>=start);
+      if (received.size()==events.size())
+      {
+        client.close();
+        server.stop();
+      }
+    }
+  }};
+
+  client.connect(on_connect,on_message);
+  ioc.run();
+
+  BOOST_CHECK(connected);
+  BOOST_CHECK(subscribed);
+  BOOST_CHECK(stamped);
+  BOOST_REQUIRE_EQUAL(received.size(),events.size());
+  for (std::size_t i=0; i<events.size(); i++)
+  {
+    BOOST_CHECK_EQUAL(received[i].timestamp,events[i].timestamp);
+    BOOST_CHECK_EQUAL(received[i].station,events[i].station);
+  }
+  BOOST_CHECK_EQUAL(server.pending_message_count(),0);
+  BOOST_CHECK_EQUAL(server.dropped_message_count(),0);
+} // BOOST_AUTO_TEST_CASE(class_PassengerFeedServer)
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,69 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// Regular libraries
+#include <chrono>
+
+// Headers we've defined
+#include <network-monitor/rtt_histogram.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(class_RttHistogram)
+{
+  using std::chrono::microseconds;
+
+  NetworkMonitor::RttHistogram histogram{10};
+  BOOST_CHECK_EQUAL(histogram.count(),0);
+  BOOST_CHECK(histogram.percentile(0.5)==microseconds(0));
+
+  // Small values are exact.
+  for (int i=1; i<=10; i++)
+  {
+    histogram.record(microseconds(i));
+  }
+  BOOST_CHECK_EQUAL(histogram.count(),10);
+  BOOST_CHECK(histogram.percentile(0.5)==microseconds(5));
+  BOOST_CHECK(histogram.percentile(1.0)==microseconds(10));
+  BOOST_CHECK(histogram.last()==microseconds(10));
+
+  // Large values are within the bucket resolution.
+  for (int i=0; i<10; i++)
+  {
+    histogram.record(microseconds(20000));
+  }
+  BOOST_CHECK_EQUAL(histogram.count(),10);
+  const auto median{histogram.percentile(0.5).count()};
+  BOOST_CHECK(median>=20000*7/8);
+  BOOST_CHECK(median<=20000*9/8);
+
+  histogram.clear();
+  BOOST_CHECK_EQUAL(histogram.count(),0);
+} // BOOST_AUTO_TEST_CASE(class_RttHistogram)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(RttHistogram_rolling_window)
+{
+  using std::chrono::microseconds;
+
+  // Once the window is full, old samples stop counting.
+  NetworkMonitor::RttHistogram histogram{4};
+  for (int i=0; i<4; i++)
+  {
+    histogram.record(microseconds(1));
+  }
+  for (int i=0; i<3; i++)
+  {
+    histogram.record(microseconds(12));
+  }
+  BOOST_CHECK_EQUAL(histogram.count(),4);
+  BOOST_CHECK(histogram.percentile(0.25)==microseconds(1));
+  BOOST_CHECK(histogram.percentile(0.5)==microseconds(12));
+} // BOOST_AUTO_TEST_CASE(RttHistogram_rolling_window)
+
+//=========================================================================
+
+BOOST_AUTO_TEST_SUITE_END();
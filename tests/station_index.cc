@@ -0,0 +1,63 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include <network-monitor/file_downloader.h>
+#include <network-monitor/station_index.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(station_index_from_layout)
+{
+  const nlohmann::json layout=
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  BOOST_REQUIRE_EQUAL(stations.size(),layout["stations"].size());
+
+  // Every station maps back to its position in the layout.
+  for (std::size_t i=0; i<layout["stations"].size(); i++)
+  {
+    const auto station_id
+    {
+      layout["stations"][i]["station_id"].get<std::string>()
+    };
+    BOOST_CHECK_EQUAL(stations.find(station_id),i);
+    BOOST_CHECK_EQUAL(stations.station_id(static_cast<std::uint32_t>(i)),
+                      station_id);
+  }
+} // BOOST_AUTO_TEST_CASE(station_index_from_layout)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(station_index_unknown_keys)
+{
+  const NetworkMonitor::StationIndex stations
+  {
+    std::vector<std::string>{"station_000","station_001","station_000"}
+  };
+
+  // Duplicates are ignored.
+  BOOST_CHECK_EQUAL(stations.size(),2);
+  BOOST_CHECK_EQUAL(stations.find("station_001"),1);
+  BOOST_CHECK_EQUAL(stations.find("station_002"),
+                    NetworkMonitor::StationIndex::npos);
+  BOOST_CHECK_EQUAL(stations.find(""),NetworkMonitor::StationIndex::npos);
+
+  // An empty index knows no station.
+  const NetworkMonitor::StationIndex empty{};
+  BOOST_CHECK_EQUAL(empty.find("station_000"),
+                    NetworkMonitor::StationIndex::npos);
+} // BOOST_AUTO_TEST_CASE(station_index_unknown_keys)
+
+//=========================================================================
+
+BOOST_AUTO_TEST_SUITE_END();
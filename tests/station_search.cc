@@ -0,0 +1,123 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// JSON library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include <network-monitor/file_downloader.h>
+#include <network-monitor/station_search.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+// Whether a station is in a list of matches
+static bool contains(const std::vector<NetworkMonitor::StationMatch>& matches,
+                     const std::string& station_id)
+{
+  return std::any_of(matches.begin(),matches.end(),
+                     [&station_id](const auto& match)
+  {
+    return match.station_id==station_id;
+  });
+} // End of contains
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(StationSearch_prefix)
+{
+  const nlohmann::json layout=NetworkMonitor::parse_json_file(
+    TESTS_NETWORK_LAYOUT_JSON);
+  NetworkMonitor::StationSearch search{layout};
+  BOOST_CHECK_EQUAL(search.size(),layout.at("stations").size());
+
+  // Case and punctuation do not matter; any word of the name can match.
+  auto matches{search.prefix_search("KENT")};
+  BOOST_CHECK(contains(matches,"station_001")); // Kenton
+  BOOST_CHECK(contains(matches,"station_002")); // South Kenton
+  BOOST_REQUIRE(matches.size()>=2);
+
+  // Names starting with the query come first, shortest first.
+  BOOST_CHECK_EQUAL(matches[0].name,"Kenton Rail Station");
+  BOOST_CHECK_EQUAL(matches[1].name,"Kenton Underground Station");
+
+  BOOST_CHECK(contains(search.prefix_search("harrow and weald"),
+                       "station_000"));
+  BOOST_CHECK(contains(search.prefix_search("harrow & weald"),
+                       "station_000"));
+  BOOST_CHECK(contains(search.prefix_search("queens pa"),"station_009"));
+
+  // Limits
+  BOOST_CHECK_EQUAL(search.prefix_search("s",3).size(),3);
+  BOOST_CHECK_EQUAL(search.prefix_search("s").size(),10);
+
+  // No match
+  BOOST_CHECK(search.prefix_search("xyzzy").empty());
+  BOOST_CHECK(search.prefix_search("").empty());
+} // BOOST_AUTO_TEST_CASE(StationSearch_prefix)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(StationSearch_fuzzy)
+{
+  const nlohmann::json layout=NetworkMonitor::parse_json_file(
+    TESTS_NETWORK_LAYOUT_JSON);
+  NetworkMonitor::StationSearch search{layout};
+
+  // Piccadilly Circus, with two typos
+  auto matches{search.fuzzy_search("picadily circus")};
+  BOOST_REQUIRE(!matches.empty());
+  BOOST_CHECK_EQUAL(matches[0].station_id,"station_019");
+  BOOST_CHECK(matches[0].distance>0);
+  BOOST_CHECK(matches[0].distance<=3);
+
+  // Prefix matches come first, typos complete them.
+  BOOST_CHECK(search.prefix_search("wembly").empty());
+  matches=search.search("wembly");
+  BOOST_CHECK(contains(matches,"station_003")); // North Wembley
+  BOOST_CHECK(contains(matches,"station_004")); // Wembley Central
+
+  BOOST_CHECK(search.fuzzy_search("qqqqqqqq").empty());
+} // BOOST_AUTO_TEST_CASE(StationSearch_fuzzy)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(StationSearch_reload)
+{
+  nlohmann::json layout=NetworkMonitor::parse_json_file(
+    TESTS_NETWORK_LAYOUT_JSON);
+  NetworkMonitor::StationSearch search{layout};
+  const std::size_t n_stations{search.size()};
+
+  // Nothing changed
+  BOOST_CHECK_EQUAL(search.reload(layout),0);
+
+  // Rename one station, remove another and add a new one.
+  auto& stations{layout.at("stations")};
+  stations[1]["name"]="Kentish Town Underground Station";
+  stations.erase(stations.begin()+2);
+  stations.push_back({{"station_id","station_999"},
+                      {"name","Battersea Power Station"}});
+  BOOST_CHECK_EQUAL(search.reload(layout),3);
+  BOOST_CHECK_EQUAL(search.size(),n_stations);
+
+  auto matches{search.prefix_search("kent")};
+  BOOST_CHECK(contains(matches,"station_001"));
+  BOOST_CHECK(!contains(matches,"station_002"));
+  BOOST_CHECK(contains(search.prefix_search("kentish"),"station_001"));
+  BOOST_CHECK(contains(search.prefix_search("batter"),"station_999"));
+  BOOST_CHECK(contains(search.fuzzy_search("batersea"),"station_999"));
+  BOOST_CHECK(!contains(search.fuzzy_search("south kenton"),"station_002"));
+
+  // Stations under the shards that were not rebuilt are still found.
+  BOOST_CHECK(contains(search.prefix_search("harrow"),"station_000"));
+  BOOST_CHECK(contains(search.prefix_search("wembley"),"station_004"));
+} // BOOST_AUTO_TEST_CASE(StationSearch_reload)
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,61 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// OpenSSL libraries to use SSL/TLS protocols
+#include <openssl/ssl.h>
+
+// Headers we've defined
+#include <network-monitor/tls_context.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(make_tls_client_context)
+{
+  auto first{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  auto second{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  BOOST_REQUIRE(first!=nullptr);
+  BOOST_REQUIRE(second!=nullptr);
+
+  // Two contexts, one parsed CA store
+  BOOST_CHECK(first!=second);
+  X509_STORE* store{SSL_CTX_get_cert_store(first->native_handle())};
+  BOOST_CHECK(store==SSL_CTX_get_cert_store(second->native_handle()));
+  BOOST_CHECK(sk_X509_OBJECT_num(X509_STORE_get0_objects(store))>100);
+
+  // The store outlives the contexts that use it.
+  first.reset();
+  auto third{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  BOOST_CHECK(store==SSL_CTX_get_cert_store(third->native_handle()));
+
+  BOOST_CHECK(NetworkMonitor::make_tls_client_context("no/such/file.pem")==
+              nullptr);
+} // BOOST_AUTO_TEST_CASE(make_tls_client_context)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(ktls_supported)
+{
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+  BOOST_CHECK(NetworkMonitor::ktls_supported());
+#else
+  BOOST_CHECK(!NetworkMonitor::ktls_supported());
+#endif
+} // BOOST_AUTO_TEST_CASE(ktls_supported)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(make_tls_server_context)
+{
+  auto ctx{NetworkMonitor::make_tls_server_context(TESTS_SERVER_CERT_PEM,
+                                                   TESTS_SERVER_KEY_PEM)};
+  BOOST_REQUIRE(ctx!=nullptr);
+  BOOST_CHECK(SSL_CTX_get0_certificate(ctx->native_handle())!=nullptr);
+
+  // The context is useless without its private key.
+  BOOST_CHECK(NetworkMonitor::make_tls_server_context(
+    TESTS_SERVER_CERT_PEM,"no/such/key.pem")==nullptr);
+} // BOOST_AUTO_TEST_CASE(make_tls_server_context)
+
+BOOST_AUTO_TEST_SUITE_END();
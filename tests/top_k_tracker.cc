@@ -0,0 +1,94 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// Regular libraries
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Headers we've defined
+#include <network-monitor/top_k_tracker.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(class_TopKTracker)
+{
+  NetworkMonitor::TopKTracker tracker{10,3};
+
+  // With no load, the lowest IDs come first.
+  auto top{tracker.sorted_top()};
+  BOOST_REQUIRE_EQUAL(top.size(),3);
+  BOOST_CHECK_EQUAL(top[0].id,0);
+  BOOST_CHECK_EQUAL(top[2].id,2);
+
+  tracker.set(7,50);
+  tracker.add(5,20);
+  tracker.add(5,20);
+  tracker.set(9,30);
+  BOOST_CHECK_EQUAL(tracker.load(5),40);
+  top=tracker.sorted_top();
+  BOOST_REQUIRE_EQUAL(top.size(),3);
+  BOOST_CHECK_EQUAL(top[0].id,7);
+  BOOST_CHECK_EQUAL(top[1].id,5);
+  BOOST_CHECK_EQUAL(top[2].id,9);
+
+  // Loads going down push items out of the top K.
+  tracker.add(7,-100);
+  top=tracker.sorted_top();
+  BOOST_CHECK_EQUAL(top[0].id,5);
+  BOOST_CHECK_EQUAL(top[1].id,9);
+  BOOST_CHECK_EQUAL(top[2].id,0);
+  BOOST_CHECK_EQUAL(tracker.load(7),-50);
+
+  // K larger than the number of items
+  NetworkMonitor::TopKTracker small{2,5};
+  BOOST_CHECK_EQUAL(small.top().size(),2);
+} // BOOST_AUTO_TEST_CASE(class_TopKTracker)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(TopKTracker_matches_sort)
+{
+  const std::size_t n_items{426};
+  const std::size_t k{20};
+  NetworkMonitor::TopKTracker tracker{n_items,k};
+  std::vector<std::int64_t> loads(n_items,0);
+
+  std::mt19937 generator{42};
+  std::uniform_int_distribution<std::uint32_t> item(0,n_items-1);
+  std::uniform_int_distribution<std::int64_t> delta(-20,50);
+  for (int i=0; i<20000; i++)
+  {
+    const std::uint32_t id{item(generator)};
+    const std::int64_t d{delta(generator)};
+    tracker.add(id,d);
+    loads[id]+=d;
+
+    if (i%1000!=0)
+    {
+      continue;
+    }
+    std::vector<std::uint32_t> expected(n_items);
+    for (std::uint32_t j=0; j<n_items; j++)
+    {
+      expected[j]=j;
+    }
+    std::sort(expected.begin(),expected.end(),
+              [&loads](std::uint32_t a, std::uint32_t b)
+    {
+      return (loads[a]>loads[b]) || ((loads[a]==loads[b]) && (a<b));
+    });
+    const auto top{tracker.sorted_top()};
+    BOOST_REQUIRE_EQUAL(top.size(),k);
+    for (std::size_t j=0; j<k; j++)
+    {
+      BOOST_CHECK_EQUAL(top[j].id,expected[j]);
+      BOOST_CHECK_EQUAL(top[j].load,loads[expected[j]]);
+    }
+  }
+} // BOOST_AUTO_TEST_CASE(TopKTracker_matches_sort)
+
+BOOST_AUTO_TEST_SUITE_END();
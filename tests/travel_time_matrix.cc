@@ -0,0 +1,98 @@
+// Boost-specific libraries
+#include <boost/test/unit_test.hpp>
+
+// JSON parsing library
+#include <nlohmann/json.hpp>
+
+// Regular libraries
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Headers we've defined
+#include <network-monitor/file_downloader.h>
+#include <network-monitor/station_index.h>
+#include <network-monitor/travel_time_matrix.h>
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//=========================================================================
+
+BOOST_AUTO_TEST_CASE(class_TravelTimeMatrix)
+{
+  const nlohmann::json layout=
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  const NetworkMonitor::TravelTimeMatrix matrix{layout,stations,4};
+  BOOST_REQUIRE_EQUAL(matrix.size(),stations.size());
+
+  // On the Bakerloo line, station_000 -> station_001 takes 2 minutes (see
+  // travel_times), and there is no faster way around.
+  const auto s0{stations.find("station_000")};
+  const auto s1{stations.find("station_001")};
+  const auto s2{stations.find("station_002")};
+  BOOST_CHECK_EQUAL(matrix.travel_time(s0,s0),0);
+  BOOST_CHECK_EQUAL(matrix.travel_time(s0,s1),2);
+  BOOST_CHECK_EQUAL(matrix.travel_time(s1,s0),2);
+  BOOST_CHECK(matrix.travel_time(s0,s2)<=
+              matrix.travel_time(s0,s1)+matrix.travel_time(s1,s2));
+
+  // Same result on a single thread
+  const NetworkMonitor::TravelTimeMatrix serial{layout,stations,1};
+  for (std::uint32_t from=0; from<stations.size(); from++)
+  {
+    BOOST_REQUIRE_EQUAL(matrix.travel_time(from,from),0);
+    for (std::uint32_t to=0; to<stations.size(); to++)
+    {
+      BOOST_REQUIRE_EQUAL(matrix.travel_time(from,to),
+                          serial.travel_time(from,to));
+    }
+  }
+} // BOOST_AUTO_TEST_CASE(class_TravelTimeMatrix)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(TravelTimeMatrix_save_load)
+{
+  const nlohmann::json layout=
+    NetworkMonitor::parse_json_file(TESTS_NETWORK_LAYOUT_JSON);
+  const NetworkMonitor::StationIndex stations{layout};
+  const NetworkMonitor::TravelTimeMatrix matrix{layout,stations};
+  const auto destination
+  {
+    std::filesystem::temp_directory_path() / "travel-time-matrix.bin"
+  };
+  BOOST_REQUIRE(matrix.save(destination,stations));
+
+  // The mapped matrix matches the computed one.
+  const auto loaded{
+    NetworkMonitor::TravelTimeMatrix::load(destination,stations)};
+  BOOST_REQUIRE_EQUAL(loaded.size(),matrix.size());
+  for (std::uint32_t from=0; from<stations.size(); from++)
+  {
+    for (std::uint32_t to=0; to<stations.size(); to++)
+    {
+      BOOST_REQUIRE_EQUAL(loaded.travel_time(from,to),
+                          matrix.travel_time(from,to));
+    }
+  }
+
+  // A matrix built for other stations is rejected.
+  const NetworkMonitor::StationIndex other_stations
+  {
+    std::vector<std::string>{"station_000","station_001"}
+  };
+  BOOST_CHECK_EQUAL(
+    NetworkMonitor::TravelTimeMatrix::load(destination,other_stations).size(),
+    0);
+  BOOST_CHECK_EQUAL(
+    NetworkMonitor::TravelTimeMatrix::load("does-not-exist",stations).size(),
+    0);
+
+  // Clean up.
+  std::filesystem::remove(destination);
+} // BOOST_AUTO_TEST_CASE(TravelTimeMatrix_save_load)
+
+//=========================================================================
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -1,14 +1,19 @@
 // Headers we've defined
+#include "network-monitor/tls_context.h"
 #include "network-monitor/websocket_client.h"
+#include "network-monitor/websocket_server.h"
 
 // Boost-specific libraries
 #include <boost/asio.hpp>
 #include <boost/test/unit_test.hpp>
 
 // Regular libraries
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <filesystem>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(network_monitor);
 
@@ -33,14 +38,13 @@ BOOST_AUTO_TEST_CASE(class_WebSocketClient)
   // Always start with an I/O context object.
   boost::asio::io_context ioc{};
 
-  // TLS context for a secure WebSocket connection
-  boost::asio::ssl::context ctx{boost::asio::ssl::context::tlsv12_client};
-
-  // Load the Certificate Authority (CA) entities
-  ctx.load_verify_file(TESTS_CACERT_PEM);
+  // TLS context for a secure WebSocket connection. The Certificate
+  // Authority (CA) entities are loaded once and shared by every test.
+  auto ctx{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  BOOST_REQUIRE(ctx!=nullptr);
 
   // The class under test
-  NetworkMonitor::WebSocketClient client{url,endpoint,port,ioc,ctx};
+  NetworkMonitor::WebSocketClient client{url,endpoint,port,ioc,*ctx};
 
   // We use these flags to check that the connection, send, receive functions
   // work as expected.
@@ -124,14 +128,13 @@ BOOST_AUTO_TEST_CASE(test_stomp_protocol)
   // Always start with an I/O context object.
   boost::asio::io_context ioc{};
 
-  // TLS context for a secure WebSocket connection
-  boost::asio::ssl::context ctx{boost::asio::ssl::context::tlsv12_client};
-
-  // Load the Certificate Authority (CA) entities
-  ctx.load_verify_file(TESTS_CACERT_PEM);
+  // TLS context for a secure WebSocket connection. The Certificate
+  // Authority (CA) entities are loaded once and shared by every test.
+  auto ctx{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  BOOST_REQUIRE(ctx!=nullptr);
 
   // The class under test
-  NetworkMonitor::WebSocketClient client{url,endpoint,port,ioc,ctx};
+  NetworkMonitor::WebSocketClient client{url,endpoint,port,ioc,*ctx};
 
   // We use these flags to check that the connection, send, receive functions
   // work as expected.
@@ -182,5 +185,109 @@ BOOST_AUTO_TEST_CASE(test_stomp_protocol)
 
 //-------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE(WebSocketClient_ping)
+{
+  // Connection targets
+  const std::string url {"ltnm.learncppthroughprojects.com"};
+  const std::string endpoint {"/network-events"};
+  const std::string port{"443"};
+
+  // Always start with an I/O context object.
+  boost::asio::io_context ioc{};
+
+  // TLS context for a secure WebSocket connection. The Certificate
+  // Authority (CA) entities are loaded once and shared by every test.
+  auto ctx{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  BOOST_REQUIRE(ctx!=nullptr);
+
+  // The class under test
+  NetworkMonitor::WebSocketClient client{url,endpoint,port,ioc,*ctx};
+
+  // Ping until we have a few round-trip times, then leave.
+  const std::size_t n_pongs{3};
+  std::size_t pongs_received{0};
+  bool positive_rtt{true};
+  auto on_rtt{[&client,&pongs_received,&positive_rtt](auto rtt)
+  {
+    positive_rtt&=(rtt.count()>0);
+    if (++pongs_received==n_pongs)
+    {
+      client.close();
+    }
+  }};
+
+  client.start_ping(std::chrono::milliseconds(100),on_rtt);
+  client.connect();
+  ioc.run();
+
+  BOOST_CHECK_EQUAL(pongs_received,n_pongs);
+  BOOST_CHECK(positive_rtt);
+  BOOST_CHECK_EQUAL(client.rtt_histogram().count(),n_pongs);
+  BOOST_CHECK(client.rtt_histogram().percentile(0.5).count()>0);
+  BOOST_CHECK_EQUAL(client.missed_pongs(),0);
+} // BOOST_AUTO_TEST_CASE(WebSocketClient_ping)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(WebSocketClient_verifies_server)
+{
+  boost::asio::io_context ioc{};
+  auto server_ctx{NetworkMonitor::make_tls_server_context(
+    TESTS_SERVER_CERT_PEM,TESTS_SERVER_KEY_PEM)};
+  BOOST_REQUIRE(server_ctx!=nullptr);
+
+  // The self-signed certificate is valid for localhost and 127.0.0.1 only.
+  NetworkMonitor::WebSocketServer server{"127.0.0.1",0,ioc,*server_ctx};
+  NetworkMonitor::WebSocketServer other_host{"127.0.0.2",0,ioc,*server_ctx};
+  BOOST_REQUIRE(!server.run());
+  BOOST_REQUIRE(!other_host.run());
+
+  // A server we trust, one signed by none of our CAs, and a certificate
+  // we trust on the wrong host
+  auto trusted{NetworkMonitor::make_tls_client_context(
+    TESTS_SERVER_CERT_PEM)};
+  auto untrusted{NetworkMonitor::make_tls_client_context(TESTS_CACERT_PEM)};
+  BOOST_REQUIRE(trusted!=nullptr);
+  BOOST_REQUIRE(untrusted!=nullptr);
+  const std::string url{"127.0.0.1"};
+  const std::string other_url{"127.0.0.2"};
+  const std::string endpoint{"/"};
+  const std::string port{std::to_string(server.port())};
+  const std::string other_port{std::to_string(other_host.port())};
+  std::vector<std::unique_ptr<NetworkMonitor::WebSocketClient>> clients{};
+  clients.push_back(std::make_unique<NetworkMonitor::WebSocketClient>(
+    url,endpoint,port,ioc,*trusted));
+  clients.push_back(std::make_unique<NetworkMonitor::WebSocketClient>(
+    url,endpoint,port,ioc,*untrusted));
+  clients.push_back(std::make_unique<NetworkMonitor::WebSocketClient>(
+    other_url,endpoint,other_port,ioc,*trusted));
+
+  std::vector<bool> connected(clients.size(),false);
+  std::size_t n_done{0};
+  for (std::size_t i=0; i<clients.size(); i++)
+  {
+    clients[i]->connect([&,i](auto err_code)
+    {
+      connected[i]=!err_code;
+      if (connected[i])
+      {
+        clients[i]->close();
+      }
+      if (++n_done==clients.size())
+      {
+        server.stop();
+        other_host.stop();
+      }
+    });
+  }
+  ioc.run();
+
+  BOOST_CHECK(connected[0]);
+  BOOST_CHECK(!connected[1]);
+  BOOST_CHECK(!connected[2]);
+} // BOOST_AUTO_TEST_CASE(WebSocketClient_verifies_server)
+
+//-------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END();
 
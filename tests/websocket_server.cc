@@ -0,0 +1,231 @@
+// Headers we've defined
+#include "network-monitor/websocket_server.h"
+
+// Boost-specific libraries
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/test/unit_test.hpp>
+
+// Regular libraries
+#include <memory>
+#include <string>
+#include <vector>
+
+using tcp_web_socket =
+  boost::beast::websocket::stream<boost::beast::tcp_stream>;
+
+//=========================================================================
+// Minimal plain-TCP subscriber: connect, then record every message until
+// the server drops the connection.
+//=========================================================================
+static void subscribe(tcp_web_socket& ws,
+                      unsigned short port,
+                      boost::beast::flat_buffer& buffer,
+                      std::vector<std::string>& received)
+{
+  const boost::asio::ip::tcp::endpoint endpoint{
+    boost::asio::ip::make_address("127.0.0.1"),port};
+  boost::beast::get_lowest_layer(ws).async_connect(
+    endpoint,
+    [&ws,&buffer,&received](auto ec)
+  {
+    BOOST_REQUIRE(!ec);
+    ws.async_handshake(
+      "127.0.0.1","/",
+      [&ws,&buffer,&received](auto ec)
+    {
+      BOOST_REQUIRE(!ec);
+      auto read_next_pt{std::make_shared<std::function<void ()>>()};
+      *read_next_pt=[&ws,&buffer,&received,read_next_pt]()
+      {
+        ws.async_read(
+          buffer,
+          [&buffer,&received,read_next_pt](auto ec, auto)
+        {
+          if (ec)
+          {
+            // Break the reference cycle.
+            *read_next_pt=nullptr;
+            return;
+          }
+          received.push_back(
+            boost::beast::buffers_to_string(buffer.data()));
+          buffer.consume(buffer.size());
+          (*read_next_pt)();
+        });
+      };
+      (*read_next_pt)();
+    });
+  });
+} // End of subscribe
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(class_WebSocketServer)
+{
+  boost::asio::io_context ioc{};
+
+  // The class under test
+  NetworkMonitor::WebSocketServer server{"127.0.0.1",0,ioc};
+
+  const std::size_t n_subscribers{3};
+  std::size_t n_subscribed{0};
+  std::size_t n_unsubscribed{0};
+  auto on_subscribe{[&](auto ec)
+  {
+    BOOST_CHECK(!ec);
+    if (++n_subscribed==n_subscribers)
+    {
+      server.broadcast("Hello");
+      server.broadcast("World");
+    }
+  }};
+  auto on_unsubscribe{[&n_unsubscribed](auto)
+  {
+    n_unsubscribed++;
+  }};
+  BOOST_REQUIRE(!server.run(on_subscribe,on_unsubscribe));
+  BOOST_REQUIRE(server.port()!=0);
+
+  std::vector<std::unique_ptr<tcp_web_socket>> clients{};
+  std::vector<boost::beast::flat_buffer> buffers(n_subscribers);
+  std::vector<std::vector<std::string>> received(n_subscribers);
+  for (std::size_t i=0; i<n_subscribers; i++)
+  {
+    clients.push_back(std::make_unique<tcp_web_socket>(ioc));
+    subscribe(*clients[i],server.port(),buffers[i],received[i]);
+  }
+
+  // Stop the server once every subscriber got both messages.
+  boost::asio::steady_timer timer{ioc};
+  std::function<void (boost::system::error_code)> poll{};
+  poll=[&](auto)
+  {
+    bool done{true};
+    for (const auto& messages : received)
+    {
+      done&=(messages.size()==2);
+    }
+    if (done)
+    {
+      server.stop();
+      return;
+    }
+    timer.expires_after(std::chrono::milliseconds(10));
+    timer.async_wait(poll);
+  };
+  poll({});
+
+  ioc.run_for(std::chrono::seconds(10));
+
+  BOOST_CHECK_EQUAL(n_subscribed,n_subscribers);
+  BOOST_CHECK_EQUAL(n_unsubscribed,n_subscribers);
+  BOOST_CHECK_EQUAL(server.subscriber_count(),0);
+  for (const auto& messages : received)
+  {
+    BOOST_REQUIRE_EQUAL(messages.size(),2);
+    BOOST_CHECK_EQUAL(messages[0],"Hello");
+    BOOST_CHECK_EQUAL(messages[1],"World");
+  }
+} // BOOST_AUTO_TEST_CASE(class_WebSocketServer)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(WebSocketServer_slow_client)
+{
+  boost::asio::io_context ioc{};
+
+  // Room for a single message per subscriber
+  NetworkMonitor::WebSocketServer server
+  {
+    "127.0.0.1",0,ioc,1,
+    NetworkMonitor::WebSocketServer::SlowClientPolicy::DropMessages
+  };
+
+  // The three messages reach the session before the first write completes,
+  // so the last two do not fit in its queue.
+  auto on_subscribe{[&server](auto)
+  {
+    server.broadcast("1");
+    server.broadcast("2");
+    server.broadcast("3");
+  }};
+  BOOST_REQUIRE(!server.run(on_subscribe));
+
+  tcp_web_socket client{ioc};
+  boost::beast::flat_buffer buffer{};
+  std::vector<std::string> received{};
+  subscribe(client,server.port(),buffer,received);
+
+  boost::asio::steady_timer timer{ioc};
+  timer.expires_after(std::chrono::milliseconds(200));
+  timer.async_wait([&server](auto)
+  {
+    server.stop();
+  });
+  ioc.run_for(std::chrono::seconds(10));
+
+  BOOST_REQUIRE_EQUAL(received.size(),1);
+  BOOST_CHECK_EQUAL(received[0],"1");
+  BOOST_CHECK_EQUAL(server.dropped_message_count(),2);
+} // BOOST_AUTO_TEST_CASE(WebSocketServer_slow_client)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(WebSocketServer_slow_client_disconnect)
+{
+  boost::asio::io_context ioc{};
+
+  // Room for two messages per subscriber, with the default policy
+  NetworkMonitor::WebSocketServer server{"127.0.0.1",0,ioc,2};
+
+  // The four messages reach the session before the first write completes:
+  // the third one does not fit and gets the subscriber disconnected, and
+  // the fourth one finds the session closed.
+  const std::string message(1<<20,'x');
+  std::size_t n_unsubscribed{0};
+  auto on_subscribe{[&server,&message](auto ec)
+  {
+    BOOST_REQUIRE(!ec);
+    for (int i=0; i<4; i++)
+    {
+      server.broadcast(message);
+    }
+  }};
+  auto on_unsubscribe{[&server,&n_unsubscribed](auto)
+  {
+    n_unsubscribed++;
+    server.stop();
+  }};
+  BOOST_REQUIRE(!server.run(on_subscribe,on_unsubscribe));
+
+  // A stalled subscriber: it completes the handshake and never reads.
+  tcp_web_socket client{ioc};
+  const boost::asio::ip::tcp::endpoint endpoint{
+    boost::asio::ip::make_address("127.0.0.1"),server.port()};
+  boost::beast::get_lowest_layer(client).async_connect(
+    endpoint,
+    [&client](auto ec)
+  {
+    BOOST_REQUIRE(!ec);
+    client.async_handshake(
+      "127.0.0.1","/",
+      [](auto ec)
+    {
+      BOOST_REQUIRE(!ec);
+    });
+  });
+
+  ioc.run_for(std::chrono::seconds(10));
+
+  BOOST_CHECK_EQUAL(n_unsubscribed,1);
+  BOOST_CHECK_EQUAL(server.subscriber_count(),0);
+  BOOST_CHECK_EQUAL(server.dropped_message_count(),1);
+  BOOST_CHECK_EQUAL(server.pending_message_count(),0);
+} // BOOST_AUTO_TEST_CASE(WebSocketServer_slow_client_disconnect)
+
+//-------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END();